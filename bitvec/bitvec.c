@@ -0,0 +1,352 @@
+/*
+	======= bitvec.h =======
+
+	This library provides a new object 'bitvec'
+	that stores a vector of bits packed in 64-bit words,
+	e.g. to hold boolean masks over arrays
+	with one bit per member instead of one int.
+
+	To create a new bit vector of 'n' bits, use:
+		bitvec *b = bvnew(n);
+
+	To set, clear and test a bit, use:
+		bvset(b, i);
+		bvclear(b, i);
+		int bit = bvtest(b, i);
+
+	To count the bits set to one, use:
+		size_t ones = bvpopcount(b);
+
+	To free a bit vector, use:
+		bvfree(b);
+
+	Counting and combining bit vectors works on whole words,
+	64 bits at a time. bvrank reads a table of counts per
+	block of words, rebuilt on the first call after a write.
+
+
+
+
+	----- Version History -----
+
+	1.0 - 17/10/2026
+		- Added basic bit vector functions:
+		bvnew, bvfree, bvsize, bvwords, bvnwords, bvresize,
+		bvset, bvclear, bvassign, bvtest, bvfill.
+		- Added counting functions: bvpopcount, bvrank, bvnext.
+		- Added word-wise operations:
+		bvand, bvor, bvxor, bvandnot, bvnot.
+
+	1.1 - 17/10/2026
+		- bvrank takes constant time, reading a table of counts
+			per block of words rebuilt lazily after writes.
+
+
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "bitvec.h"
+
+
+
+//		WORD FUNCTIONS
+
+/* Returns the number of bits set to one in a word */
+static inline size_t bvpopword(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return (size_t)__builtin_popcountll(x);
+#else
+	x = x - ((x >> 1) & 0x5555555555555555ull);
+	x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+	x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0full;
+	return (size_t)((x * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+/* Returns the index of the lowest bit set to one in a non-zero word */
+static inline size_t bvlowbit(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return (size_t)__builtin_ctzll(x);
+#else
+	size_t k = 0;
+	while(!(x & 1)){
+		x >>= 1;
+		k++;
+	}
+	return k;
+#endif
+}
+
+/* Clears the bits past the size in the last word */
+static void bvtrim(bitvec *b)
+{
+	size_t r = b->size % BITVEC_WORD;
+	if(r)
+		b->w[b->nwords-1] &= ((uint64_t)1 << r) - 1;
+}
+
+
+
+//		ALLOCATION
+
+/* Allocates new bit vector of 'n' bits set to zero */
+bitvec *bvnew(size_t n)
+{
+	bitvec *b = malloc(sizeof(bitvec));
+	if(!b)
+		return NULL;
+	b->nwords = BITVEC_WORDS(n);
+	b->w = calloc(b->nwords ? b->nwords : 1, sizeof(uint64_t));
+	if(!b->w){
+		free(b);
+		return NULL;
+	}
+	b->size = n;
+	b->ranks = NULL;
+	b->ranked = 0;
+	return b;
+}
+
+/* Frees the bit vector */
+void bvfree(bitvec *b)
+{
+	if(!b)
+		return;
+	free(b->ranks);
+	free(b->w);
+	free(b);
+}
+
+/* Returns the number of bits */
+size_t bvsize(bitvec *b)
+{
+	return b->size;
+}
+
+/*
+Returns a pointer to the words of the bit vector.
+The caller may write through it, so the rank table is stale.
+*/
+uint64_t *bvwords(bitvec *b)
+{
+	b->ranked = 0;
+	return b->w;
+}
+
+/* Returns the number of words of the bit vector */
+size_t bvnwords(bitvec *b)
+{
+	return b->nwords;
+}
+
+/*
+Changes the number of bits to 'n'.
+New bits are set to zero.
+*/
+bitvec *bvresize(bitvec *b, size_t n)
+{
+	size_t nw = BITVEC_WORDS(n);
+	if(nw != b->nwords){
+		uint64_t *w = realloc(b->w, (nw ? nw : 1)*sizeof(uint64_t));
+		if(!w)
+			return NULL;
+		if(nw > b->nwords)
+			memset(w + b->nwords, 0, (nw - b->nwords)*sizeof(uint64_t));
+		b->w = w;
+		b->nwords = nw;
+	}
+	b->size = n;
+	b->ranked = 0;
+	bvtrim(b);
+	return b;
+}
+
+
+
+//		BIT ACCESS
+
+/* Sets bit 'i' to one */
+bitvec *bvset(bitvec *b, size_t i)
+{
+	if(i >= b->size)
+		return NULL;
+	b->w[i / BITVEC_WORD] |= (uint64_t)1 << (i % BITVEC_WORD);
+	b->ranked = 0;
+	return b;
+}
+
+/* Sets bit 'i' to zero */
+bitvec *bvclear(bitvec *b, size_t i)
+{
+	if(i >= b->size)
+		return NULL;
+	b->w[i / BITVEC_WORD] &= ~((uint64_t)1 << (i % BITVEC_WORD));
+	b->ranked = 0;
+	return b;
+}
+
+/* Sets bit 'i' to one if 'val' is non-zero, or zero otherwise */
+bitvec *bvassign(bitvec *b, size_t i, int val)
+{
+	return val ? bvset(b, i) : bvclear(b, i);
+}
+
+/* Returns bit 'i', or zero if it is out of range */
+int bvtest(bitvec *b, size_t i)
+{
+	if(i >= b->size)
+		return 0;
+	return (int)((b->w[i / BITVEC_WORD] >> (i % BITVEC_WORD)) & 1);
+}
+
+/* Sets every bit to one if 'val' is non-zero, or zero otherwise */
+bitvec *bvfill(bitvec *b, int val)
+{
+	memset(b->w, val ? 0xff : 0, b->nwords*sizeof(uint64_t));
+	b->ranked = 0;
+	bvtrim(b);
+	return b;
+}
+
+
+
+//		COUNTING
+
+/* Returns the number of bits set to one */
+size_t bvpopcount(bitvec *b)
+{
+	size_t n = 0;
+	for(size_t k=0; k<b->nwords; k++)
+		n += bvpopword(b->w[k]);
+	return n;
+}
+
+/*
+Rebuilds the rank table, with one count per block of words
+and the total at the end. Returns zero if it cannot be allocated.
+*/
+static int bvrank_build(bitvec *b)
+{
+	size_t nblocks = (b->nwords + BITVEC_RANK_WORDS - 1) / BITVEC_RANK_WORDS;
+	size_t *r = realloc(b->ranks, (nblocks+1)*sizeof(size_t));
+	if(!r)
+		return 0;
+	b->ranks = r;
+	size_t n = 0;
+	for(size_t k=0; k<b->nwords; k++){
+		if(k % BITVEC_RANK_WORDS == 0)
+			r[k / BITVEC_RANK_WORDS] = n;
+		n += bvpopword(b->w[k]);
+	}
+	r[nblocks] = n;
+	b->ranked = 1;
+	return 1;
+}
+
+/*
+Returns the number of bits set to one before bit 'i'.
+The count of the block of 'i' is read from the rank table,
+and the words before 'i' in the block are added to it.
+If the table cannot be rebuilt, all the words before 'i' are counted.
+*/
+size_t bvrank(bitvec *b, size_t i)
+{
+	int ranked = b->ranked || bvrank_build(b);
+	if(i >= b->size)
+		return ranked ? b->ranks[(b->nwords + BITVEC_RANK_WORDS - 1) / BITVEC_RANK_WORDS]
+			: bvpopcount(b);
+	size_t last = i / BITVEC_WORD;
+	size_t k = ranked ? last / BITVEC_RANK_WORDS * BITVEC_RANK_WORDS : 0;
+	size_t n = ranked ? b->ranks[last / BITVEC_RANK_WORDS] : 0;
+	for(; k<last; k++)
+		n += bvpopword(b->w[k]);
+	size_t r = i % BITVEC_WORD;
+	if(r)
+		n += bvpopword(b->w[last] & (((uint64_t)1 << r) - 1));
+	return n;
+}
+
+/*
+Returns the index of the first bit set to one at or after 'i',
+or bvsize(b) if there is none.
+*/
+size_t bvnext(bitvec *b, size_t i)
+{
+	if(i >= b->size)
+		return b->size;
+	size_t k = i / BITVEC_WORD;
+	uint64_t x = b->w[k] & (~(uint64_t)0 << (i % BITVEC_WORD));
+	while(!x){
+		if(++k == b->nwords)
+			return b->size;
+		x = b->w[k];
+	}
+	return k*BITVEC_WORD + bvlowbit(x);
+}
+
+
+
+//		WORD-WISE OPERATIONS
+
+/* Stores in 'dest' the bits set in both 'a' and 'b' */
+bitvec *bvand(bitvec *dest, bitvec *a, bitvec *b)
+{
+	if(a->size != dest->size || b->size != dest->size)
+		return NULL;
+	for(size_t k=0; k<dest->nwords; k++)
+		dest->w[k] = a->w[k] & b->w[k];
+	dest->ranked = 0;
+	return dest;
+}
+
+/* Stores in 'dest' the bits set in 'a' or 'b' */
+bitvec *bvor(bitvec *dest, bitvec *a, bitvec *b)
+{
+	if(a->size != dest->size || b->size != dest->size)
+		return NULL;
+	for(size_t k=0; k<dest->nwords; k++)
+		dest->w[k] = a->w[k] | b->w[k];
+	dest->ranked = 0;
+	return dest;
+}
+
+/* Stores in 'dest' the bits set in only one of 'a' and 'b' */
+bitvec *bvxor(bitvec *dest, bitvec *a, bitvec *b)
+{
+	if(a->size != dest->size || b->size != dest->size)
+		return NULL;
+	for(size_t k=0; k<dest->nwords; k++)
+		dest->w[k] = a->w[k] ^ b->w[k];
+	dest->ranked = 0;
+	return dest;
+}
+
+/* Clears in 'dest' the bits of 'a' that are set in 'b' */
+bitvec *bvandnot(bitvec *dest, bitvec *a, bitvec *b)
+{
+	if(a->size != dest->size || b->size != dest->size)
+		return NULL;
+	for(size_t k=0; k<dest->nwords; k++)
+		dest->w[k] = a->w[k] & ~b->w[k];
+	dest->ranked = 0;
+	return dest;
+}
+
+/* Stores in 'dest' the inverted bits of 'a' */
+bitvec *bvnot(bitvec *dest, bitvec *a)
+{
+	if(a->size != dest->size)
+		return NULL;
+	for(size_t k=0; k<dest->nwords; k++)
+		dest->w[k] = ~a->w[k];
+	dest->ranked = 0;
+	bvtrim(dest);
+	return dest;
+}
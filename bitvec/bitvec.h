@@ -0,0 +1,120 @@
+#ifndef BITVEC_H
+#define BITVEC_H 1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+
+/* Number of bits per word */
+#define BITVEC_WORD 64
+
+/* Number of words needed to hold 'n' bits */
+#define BITVEC_WORDS(n) (((n) + BITVEC_WORD - 1) / BITVEC_WORD)
+
+/* Number of words per block of the rank table */
+#define BITVEC_RANK_WORDS 8
+
+
+/*
+Vector of bits packed in 64-bit words.
+Bit 'i' is bit 'i % 64' of word 'i / 64'.
+Bits past 'size' in the last word are always zero,
+so that whole words can be counted and combined.
+'ranks' holds the number of bits set to one before each block
+of BITVEC_RANK_WORDS words, and is rebuilt by bvrank
+when 'ranked' is zero, which every write sets.
+*/
+typedef struct bitvecStruct
+{
+	uint64_t *w;
+	size_t size;
+	size_t nwords;
+	size_t *ranks;
+	int ranked;
+} bitvec;
+
+
+
+/* Allocates new bit vector of 'n' bits set to zero */
+bitvec *bvnew(size_t n);
+
+/* Frees the bit vector */
+void bvfree(bitvec *b);
+
+/* Returns the number of bits */
+size_t bvsize(bitvec *b);
+
+/*
+Returns a pointer to the words of the bit vector,
+e.g. to fill them with the '_mask' functions of utils.h.
+Writes must leave the bits past the size as zero.
+The rank table is marked stale by each call, so a pointer
+kept across calls to bvrank must be fetched again after writes.
+*/
+uint64_t *bvwords(bitvec *b);
+
+/* Returns the number of words of the bit vector */
+size_t bvnwords(bitvec *b);
+
+/*
+Changes the number of bits to 'n'.
+New bits are set to zero.
+*/
+bitvec *bvresize(bitvec *b, size_t n);
+
+/* Sets bit 'i' to one */
+bitvec *bvset(bitvec *b, size_t i);
+
+/* Sets bit 'i' to zero */
+bitvec *bvclear(bitvec *b, size_t i);
+
+/* Sets bit 'i' to one if 'val' is non-zero, or zero otherwise */
+bitvec *bvassign(bitvec *b, size_t i, int val);
+
+/* Returns bit 'i', or zero if it is out of range */
+int bvtest(bitvec *b, size_t i);
+
+/* Sets every bit to one if 'val' is non-zero, or zero otherwise */
+bitvec *bvfill(bitvec *b, int val);
+
+/* Returns the number of bits set to one */
+size_t bvpopcount(bitvec *b);
+
+/*
+Returns the number of bits set to one before bit 'i',
+so that bvrank(b, bvsize(b)) equals bvpopcount(b).
+Takes constant time, except for the first call after
+a write, which rebuilds the rank table in linear time.
+*/
+size_t bvrank(bitvec *b, size_t i);
+
+/*
+Returns the index of the first bit set to one at or after 'i',
+or bvsize(b) if there is none.
+e.g.
+	for(size_t i = bvnext(b, 0); i < bvsize(b); i = bvnext(b, i+1))
+		...
+*/
+size_t bvnext(bitvec *b, size_t i);
+
+/*
+Word-wise operations: store in 'dest' the result of combining
+the bits of 'a' and 'b', which must have the same size as 'dest'.
+'dest' may be one of the operands.
+Return NULL if the sizes differ.
+*/
+bitvec *bvand(bitvec *dest, bitvec *a, bitvec *b);
+bitvec *bvor(bitvec *dest, bitvec *a, bitvec *b);
+bitvec *bvxor(bitvec *dest, bitvec *a, bitvec *b);
+
+/* Clears in 'dest' the bits of 'a' that are set in 'b' */
+bitvec *bvandnot(bitvec *dest, bitvec *a, bitvec *b);
+
+/* Stores in 'dest' the inverted bits of 'a' */
+bitvec *bvnot(bitvec *dest, bitvec *a);
+
+
+
+#endif
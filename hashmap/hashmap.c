@@ -0,0 +1,405 @@
+/*
+	======= hashmap.h =======
+
+	This library provides a new object 'hashmap'
+	that associates keys with values, for keys and
+	values of any data type and structure.
+	Lookups, insertions and deletions take constant time
+	on average.
+
+	To create a new hash map, use:
+		hashmap *m = hmnew( sizeof(K), sizeof(V), NULL, NULL );
+	where K and V are the data types of keys and values.
+
+	To store a value 'val' with a key 'key', use:
+		hmput( m, &key, &val );
+
+	To retrieve a pointer to the value of a key, use:
+		V *ptr = hmget( m, &key );
+
+	To delete a key, use:
+		hmdelete( m, &key );
+
+	To free a hash map, use:
+		hmfree(m);
+
+	Keys are stored in a single array with open addressing.
+	Collisions are resolved with Robin Hood probing, which keeps
+	every key close to the slot it hashes to, and deleted keys
+	are removed by shifting the following keys back,
+	so that no tombstones are left behind.
+
+
+
+
+	----- Version History -----
+
+	1.0 - 17/10/2026
+		- Added basic hash map functions:
+		hmnew, hmfree, hmsize, hmclear, hmreserve,
+		hmget, hmput, hmdelete, hmnext.
+		- Added hash and equality functions for
+		byte keys and string keys.
+
+	1.1 - 17/10/2026
+		- Every hash is now mixed, so that custom hash functions
+			with weak lower bits spread keys over the slots.
+		- hmput no longer grows the map without limit when
+			too many keys share a hash: it fails instead.
+
+
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "hashmap.h"
+
+
+/* Largest probe distance that fits in a metadata byte */
+#define HASHMAP_MAX_DIST UINT8_MAX
+
+
+
+//		HASH FUNCTIONS
+
+/* Mixes the bits of a hash so that its lower bits are usable */
+static size_t hmmix(uint64_t h)
+{
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdull;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ull;
+	h ^= h >> 33;
+	return (size_t)h;
+}
+
+/* Hashes the bytes of a key with FNV-1a */
+size_t hmhash_bytes(const void *key, size_t ksize)
+{
+	const unsigned char *p = key;
+	uint64_t h = 0xcbf29ce484222325ull;
+	for(size_t i=0; i<ksize; i++){
+		h ^= p[i];
+		h *= 0x100000001b3ull;
+	}
+	return (size_t)h;
+}
+
+/* Compares the bytes of two keys */
+int hmeq_bytes(const void *a, const void *b, size_t ksize)
+{
+	return memcmp(a, b, ksize) == 0;
+}
+
+/* Hashes a key that is a pointer to a string */
+size_t hmhash_str(const void *key, size_t ksize)
+{
+	(void) ksize;
+	const char *s = *(const char **)key;
+	return hmhash_bytes(s, strlen(s));
+}
+
+/* Compares two keys that are pointers to strings */
+int hmeq_str(const void *a, const void *b, size_t ksize)
+{
+	(void) ksize;
+	return strcmp(*(const char **)a, *(const char **)b) == 0;
+}
+
+
+
+//		CONSTRUCTION
+
+/* Returns the largest power of two that divides 'n', up to 16 */
+static size_t hmalign(size_t n)
+{
+	size_t a = 1;
+	while(a < 16 && n % (2*a) == 0)
+		a *= 2;
+	return a;
+}
+
+/*
+Allocates new hash map with keys of 'ksize' bytes
+and values of 'vsize' bytes, and returns pointer to it.
+If 'hash' or 'eq' are NULL, keys are hashed and compared
+byte by byte.
+*/
+hashmap *hmnew(size_t ksize, size_t vsize, hmhash_fn hash, hmeq_fn eq)
+{
+	hashmap *m = malloc(sizeof(hashmap));
+	if(!m)
+		return NULL;
+
+	//Keep keys and values aligned to their own size
+	size_t ka = hmalign(ksize), va = hmalign(vsize);
+	size_t align = ka > va ? ka : va;
+	m->voffset = (ksize + va - 1) / va * va;
+	m->stride = (m->voffset + vsize + align - 1) / align * align;
+	if(m->stride == 0)
+		m->stride = 1;
+
+	m->meta = NULL;
+	m->slots = NULL;
+	m->size = 0;
+	m->capacity = 0;
+	m->ksize = ksize;
+	m->vsize = vsize;
+	m->hash = hash ? hash : hmhash_bytes;
+	m->eq = eq ? eq : hmeq_bytes;
+	return m;
+}
+
+/* Frees the hash map */
+void hmfree(hashmap *m)
+{
+	if(!m)
+		return;
+	free(m->meta);
+	free(m->slots);
+	free(m);
+}
+
+/* Returns the number of keys in the map */
+size_t hmsize(hashmap *m)
+{
+	return m->size;
+}
+
+/* Removes every key from the map, keeping its memory */
+hashmap *hmclear(hashmap *m)
+{
+	if(m->meta)
+		memset(m->meta, 0, m->capacity);
+	m->size = 0;
+	return m;
+}
+
+
+
+//		PROBING
+
+/*
+Returns the hash of 'key', mixed so that the lower bits
+used to pick its home slot depend on every bit of the hash
+*/
+static inline size_t hmhash(hashmap *m, const void *key)
+{
+	return hmmix(m->hash(key, m->ksize));
+}
+
+/* Returns a pointer to slot 'i' */
+static inline char *hmslot(hashmap *m, size_t i)
+{
+	return (char*)m->slots + i*m->stride;
+}
+
+/*
+Returns the index of the slot holding 'key',
+or the capacity of the map if it is not found.
+*/
+static size_t hmfind(hashmap *m, const void *key, size_t h)
+{
+	if(m->size == 0)
+		return m->capacity;
+	size_t mask = m->capacity - 1;
+	size_t i = h & mask;
+
+	//A key is never further from its home than the key it would displace
+	for(unsigned dist=1; m->meta[i] >= dist; dist++){
+		if(m->meta[i] == dist && m->eq(hmslot(m, i), key, m->ksize))
+			return i;
+		i = (i+1) & mask;
+	}
+	return m->capacity;
+}
+
+/*
+Makes room for a new key with hash 'h' and returns its slot,
+shifting forward the keys closer to their home than it would be.
+Returns the capacity of the map if a probe distance would not fit
+in its metadata, in which case the map is left untouched.
+*/
+static size_t hmslot_new(hashmap *m, size_t h)
+{
+	size_t mask = m->capacity - 1;
+	size_t i = h & mask;
+	unsigned dist = 1;
+
+	//Find where the key belongs
+	while(m->meta[i] >= dist){
+		i = (i+1) & mask;
+		dist++;
+		if(dist >= HASHMAP_MAX_DIST)
+			return m->capacity;
+	}
+
+	//Find the end of the run of keys that must be shifted
+	size_t e = i;
+	while(m->meta[e] != 0){
+		if(m->meta[e] >= HASHMAP_MAX_DIST - 1)
+			return m->capacity;
+		e = (e+1) & mask;
+	}
+
+	//Shift every key in the run forward by one slot
+	while(e != i){
+		size_t p = (e-1) & mask;
+		memcpy(hmslot(m, e), hmslot(m, p), m->stride);
+		m->meta[e] = m->meta[p] + 1;
+		e = p;
+	}
+	m->meta[i] = dist;
+	return i;
+}
+
+/* Moves every key into new arrays of 'cap' slots */
+static hashmap *hmrehash(hashmap *m, size_t cap)
+{
+	if(cap > SIZE_MAX / m->stride)
+		return NULL;
+	uint8_t *meta = calloc(cap, 1);
+	void *slots = malloc(cap*m->stride);
+	if(!meta || !slots){
+		free(meta);
+		free(slots);
+		return NULL;
+	}
+
+	hashmap n = *m;
+	n.meta = meta;
+	n.slots = slots;
+	n.capacity = cap;
+	for(size_t i=0; i<m->capacity; i++){
+		if(m->meta[i] == 0)
+			continue;
+		char *src = hmslot(m, i);
+		size_t j = hmslot_new(&n, hmhash(&n, src));
+		if(j == cap){
+			free(meta);
+			free(slots);
+			return NULL;
+		}
+		memcpy(hmslot(&n, j), src, m->stride);
+	}
+
+	free(m->meta);
+	free(m->slots);
+	*m = n;
+	return m;
+}
+
+/*
+Allocates memory for at least 'n' keys,
+so that inserting them does not grow the map.
+*/
+hashmap *hmreserve(hashmap *m, size_t n)
+{
+	size_t cap = m->capacity ? m->capacity : HASHMAP_MIN_CAPACITY;
+	while(cap / HASHMAP_LOAD_DEN * HASHMAP_LOAD_NUM < n){
+		if(cap > SIZE_MAX/2)
+			return NULL;
+		cap *= 2;
+	}
+	if(cap == m->capacity)
+		return m;
+	return hmrehash(m, cap);
+}
+
+
+
+//		ACCESS
+
+/*
+Returns a pointer to the value stored with 'key',
+or NULL if the key is not in the map.
+*/
+void *hmget(hashmap *m, const void *key)
+{
+	size_t i = hmfind(m, key, hmhash(m, key));
+	if(i == m->capacity)
+		return NULL;
+	return hmslot(m, i) + m->voffset;
+}
+
+/*
+Stores 'value' with 'key', overwriting the previous value
+if the key is already in the map.
+If 'value' is NULL, the value is left uninitialised for new keys.
+Returns a pointer to the stored value, or NULL on fail,
+which includes too many keys sharing the same hash.
+*/
+void *hmput(hashmap *m, const void *key, const void *value)
+{
+	size_t h = hmhash(m, key);
+	size_t i = hmfind(m, key, h);
+
+	if(i == m->capacity){
+		if(m->size == SIZE_MAX || !hmreserve(m, m->size+1))
+			return NULL;
+
+		//Grow while probe distances do not fit, unless the map is sparse
+		while( (i = hmslot_new(m, h)) == m->capacity ){
+			if(m->size < m->capacity / HASHMAP_MIN_LOAD_DEN)
+				return NULL;
+			if(m->capacity > SIZE_MAX/2 || !hmrehash(m, m->capacity*2))
+				return NULL;
+		}
+		memcpy(hmslot(m, i), key, m->ksize);
+		m->size++;
+	}
+
+	char *dest = hmslot(m, i) + m->voffset;
+	if(value)
+		memcpy(dest, value, m->vsize);
+	return dest;
+}
+
+/*
+Removes 'key' from the map.
+Returns NULL if the key was not in the map.
+*/
+hashmap *hmdelete(hashmap *m, const void *key)
+{
+	size_t i = hmfind(m, key, hmhash(m, key));
+	if(i == m->capacity)
+		return NULL;
+
+	//Shift back the following keys that are away from their home
+	size_t mask = m->capacity - 1;
+	size_t j = (i+1) & mask;
+	while(m->meta[j] > 1){
+		memcpy(hmslot(m, i), hmslot(m, j), m->stride);
+		m->meta[i] = m->meta[j] - 1;
+		i = j;
+		j = (j+1) & mask;
+	}
+	m->meta[i] = 0;
+	m->size--;
+	return m;
+}
+
+/*
+Iterates over the keys of the map.
+Starting with '*it' set to zero, every call returns a pointer
+to the next key and stores a pointer to its value in 'value',
+if not NULL. Returns NULL once every key has been visited.
+*/
+void *hmnext(hashmap *m, size_t *it, void **value)
+{
+	for(size_t i=*it; i<m->capacity; i++){
+		if(m->meta[i] == 0)
+			continue;
+		*it = i+1;
+		char *slot = hmslot(m, i);
+		if(value)
+			*value = slot + m->voffset;
+		return slot;
+	}
+	*it = m->capacity;
+	return NULL;
+}
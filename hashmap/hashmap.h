@@ -0,0 +1,128 @@
+#ifndef HASHMAP_H
+#define HASHMAP_H 1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+
+/* Capacity of a hash map on its first allocation */
+#define HASHMAP_MIN_CAPACITY 8
+
+/*
+Maximum fraction of occupied slots, as numerator
+over denominator, before the map grows
+*/
+#define HASHMAP_LOAD_NUM 7
+#define HASHMAP_LOAD_DEN 8
+
+/*
+Probe distances that do not fit make the map grow only while
+more than 1/HASHMAP_MIN_LOAD_DEN of its slots are occupied.
+Below that, the keys share too few hashes for growth to help,
+and the insertion fails instead.
+*/
+#define HASHMAP_MIN_LOAD_DEN 8
+
+
+/*
+Hash function: returns the hash of a key of 'ksize' bytes.
+Equality function: returns non-zero if both keys are equal.
+*/
+typedef size_t (*hmhash_fn)(const void *key, size_t ksize);
+typedef int (*hmeq_fn)(const void *a, const void *b, size_t ksize);
+
+
+/*
+Hash map with open addressing and Robin Hood probing.
+For every slot, 'meta' holds its distance from the slot
+its key hashes to plus one, or zero if the slot is empty.
+Each slot of 'slots' holds a key followed by its value.
+*/
+typedef struct hashmapStruct
+{
+	uint8_t *meta;
+	void *slots;
+	size_t size;
+	size_t capacity;
+	size_t ksize;
+	size_t vsize;
+	size_t voffset;
+	size_t stride;
+	hmhash_fn hash;
+	hmeq_fn eq;
+} hashmap;
+
+
+
+/*
+Allocates new hash map with keys of 'ksize' bytes
+and values of 'vsize' bytes, and returns pointer to it.
+If 'hash' or 'eq' are NULL, keys are hashed and compared
+byte by byte.
+*/
+hashmap *hmnew(size_t ksize, size_t vsize, hmhash_fn hash, hmeq_fn eq);
+
+/* Frees the hash map */
+void hmfree(hashmap *m);
+
+/* Returns the number of keys in the map */
+size_t hmsize(hashmap *m);
+
+/* Removes every key from the map, keeping its memory */
+hashmap *hmclear(hashmap *m);
+
+/*
+Allocates memory for at least 'n' keys,
+so that inserting them does not grow the map.
+*/
+hashmap *hmreserve(hashmap *m, size_t n);
+
+/*
+Returns a pointer to the value stored with 'key',
+or NULL if the key is not in the map.
+*/
+void *hmget(hashmap *m, const void *key);
+
+/*
+Stores 'value' with 'key', overwriting the previous value
+if the key is already in the map.
+If 'value' is NULL, the value is left uninitialised for new keys.
+Returns a pointer to the stored value, or NULL on fail,
+which includes too many keys sharing the same hash.
+Pointers into the map are invalidated by later insertions and deletions.
+*/
+void *hmput(hashmap *m, const void *key, const void *value);
+
+/*
+Removes 'key' from the map.
+Returns NULL if the key was not in the map.
+*/
+hashmap *hmdelete(hashmap *m, const void *key);
+
+/*
+Iterates over the keys of the map.
+Starting with '*it' set to zero, every call returns a pointer
+to the next key and stores a pointer to its value in 'value',
+if not NULL. Returns NULL once every key has been visited.
+e.g.
+	size_t it = 0;
+	void *key, *value;
+	while( (key = hmnext(m, &it, &value)) )
+		...
+*/
+void *hmnext(hashmap *m, size_t *it, void **value);
+
+
+/* Default functions to hash and compare keys byte by byte */
+size_t hmhash_bytes(const void *key, size_t ksize);
+int hmeq_bytes(const void *a, const void *b, size_t ksize);
+
+/* Functions to use null-terminated strings, of type 'char *', as keys */
+size_t hmhash_str(const void *key, size_t ksize);
+int hmeq_str(const void *a, const void *b, size_t ksize);
+
+
+
+#endif
@@ -0,0 +1,272 @@
+/*
+	======= pqueue.h =======
+
+	This library provides a new object 'pqueue'
+	that stores members of any data type and structure
+	ordered by priority, with the first member always
+	at the top.
+	Adding and removing members takes logarithmic time.
+
+	To create a new priority queue, use:
+		pqueue *q = pqnew( sizeof(T), 0, cmp );
+	where T is the data type of the members, and 'cmp'
+	compares two members as for qsort.
+
+	To add a member 'x', use:
+		pqpush( q, &x );
+
+	To read and remove the top member, use:
+		T *top = pqpeek( q );
+		pqpop( q, &x );
+
+	To free a priority queue, use:
+		pqfree(q);
+
+	Members are stored as an implicit d-ary heap in the
+	contiguous memory of a vector, with four children per node
+	by default. Members are moved through the heap by shifting
+	the members on their path into a hole, so each level
+	costs a single copy instead of a swap.
+
+	Requires vector.c to be compiled along with it.
+
+
+
+
+	----- Version History -----
+
+	1.0 - 17/10/2026
+		- Added basic priority queue functions:
+		pqnew, pqfree, pqsize, pqreserve, pqclear,
+		pqvector, pqat, pqpeek, pqpush, pqpop.
+		- Added pqreplace, pqheapify and pqdecrease_key.
+
+
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pqueue.h"
+
+
+
+//		HEAP ORDER
+
+/* Returns a pointer to the member at index 'i', unchecked */
+static inline char *pqslot(pqueue *q, size_t i)
+{
+	return (char*)q->v->d + i*q->v->dtype;
+}
+
+/*
+Moves the hole at index 'i' towards the top while its parent
+goes after 'x', then stores 'x' in it.
+Returns the final index of 'x'.
+*/
+static size_t pqsift_up(pqueue *q, size_t i, const void *x)
+{
+	size_t dt = q->v->dtype;
+	while(i > 0){
+		size_t p = (i - 1) / q->arity;
+		if(q->cmp(x, pqslot(q, p)) >= 0)
+			break;
+		memcpy(pqslot(q, i), pqslot(q, p), dt);
+		i = p;
+	}
+	memcpy(pqslot(q, i), x, dt);
+	return i;
+}
+
+/*
+Moves the hole at index 'i' towards the bottom while its
+first child goes before 'x', then stores 'x' in it.
+Returns the final index of 'x'.
+*/
+static size_t pqsift_down(pqueue *q, size_t i, const void *x)
+{
+	size_t dt = q->v->dtype, n = q->v->size, k = q->arity;
+	for(;;){
+		//Checked before computing i*k, which could overflow
+		if(i > (n - 1) / k)
+			break;
+		size_t first = i*k + 1;
+		if(first >= n)
+			break;
+		size_t last = n - first > k ? first + k : n;
+		size_t best = first;
+		for(size_t c=first+1; c<last; c++)
+			if(q->cmp(pqslot(q, c), pqslot(q, best)) < 0)
+				best = c;
+		if(q->cmp(pqslot(q, best), x) >= 0)
+			break;
+		memcpy(pqslot(q, i), pqslot(q, best), dt);
+		i = best;
+	}
+	memcpy(pqslot(q, i), x, dt);
+	return i;
+}
+
+
+
+//		ALLOCATION
+
+/*
+Allocates new priority queue of members of 'dtype' bytes,
+ordered by 'cmp', with 'arity' children per node,
+and returns pointer to it.
+If 'arity' is zero, PQUEUE_ARITY is used.
+*/
+pqueue *pqnew(size_t dtype, size_t arity, pqcmp_fn cmp)
+{
+	pqueue *q = malloc(sizeof(pqueue));
+	if(!q)
+		return NULL;
+	q->v = vnew(dtype);
+	q->tmp = malloc(dtype ? dtype : 1);
+	if(!q->v || !q->tmp){
+		vfree(q->v);
+		free(q->tmp);
+		free(q);
+		return NULL;
+	}
+	q->arity = arity ? arity : PQUEUE_ARITY;
+	q->cmp = cmp;
+	return q;
+}
+
+/* Frees the priority queue */
+void pqfree(pqueue *q)
+{
+	if(!q)
+		return;
+	vfree(q->v);
+	free(q->tmp);
+	free(q);
+}
+
+/* Returns the number of members in the queue */
+size_t pqsize(pqueue *q)
+{
+	return vsize(q->v);
+}
+
+/* Allocates memory for at least 'n' members */
+pqueue *pqreserve(pqueue *q, size_t n)
+{
+	return vreserve(q->v, n) ? q : NULL;
+}
+
+/* Removes every member from the queue, keeping its memory */
+pqueue *pqclear(pqueue *q)
+{
+	q->v->size = 0;
+	return q;
+}
+
+/* Returns the vector that stores the members in heap order */
+vector *pqvector(pqueue *q)
+{
+	return q->v;
+}
+
+/* Returns a pointer to the member at index 'i' in heap order */
+void *pqat(pqueue *q, size_t i)
+{
+	return vat(q->v, i);
+}
+
+/* Returns a pointer to the top member, or NULL if the queue is empty */
+void *pqpeek(pqueue *q)
+{
+	return vat(q->v, 0);
+}
+
+
+
+//		INSERTION AND REMOVAL
+
+/* Adds a copy of the member 'src' to the queue */
+pqueue *pqpush(pqueue *q, const void *src)
+{
+	//'src' may point into the queue, which may be reallocated
+	memcpy(q->tmp, src, q->v->dtype);
+	if(!vemplace(q->v))
+		return NULL;
+	pqsift_up(q, q->v->size - 1, q->tmp);
+	return q;
+}
+
+/*
+Removes the top member of the queue.
+If 'dest' is not NULL, the member is copied into it.
+*/
+pqueue *pqpop(pqueue *q, void *dest)
+{
+	size_t n = q->v->size;
+	if(n == 0)
+		return NULL;
+	if(dest)
+		memcpy(dest, pqslot(q, 0), q->v->dtype);
+	memcpy(q->tmp, pqslot(q, n-1), q->v->dtype);
+	q->v->size--;
+	if(n > 1)
+		pqsift_down(q, 0, q->tmp);
+	return q;
+}
+
+/*
+Removes the top member and adds 'src' with a single pass
+through the heap.
+*/
+pqueue *pqreplace(pqueue *q, const void *src, void *dest)
+{
+	if(q->v->size == 0)
+		return pqpush(q, src);
+	memcpy(q->tmp, src, q->v->dtype);
+	if(dest)
+		memcpy(dest, pqslot(q, 0), q->v->dtype);
+	pqsift_down(q, 0, q->tmp);
+	return q;
+}
+
+/*
+Replaces the members of the queue with the 'n' members
+of the array 'arr', and orders them in linear time,
+sifting down every parent from the bottom up.
+*/
+pqueue *pqheapify(pqueue *q, const void *arr, size_t n)
+{
+	if(arr){
+		q->v->size = 0;
+		if(!vappend_array(q->v, arr, n))
+			return NULL;
+	}
+	n = q->v->size;
+	if(n < 2)
+		return q;
+	for(size_t i = (n - 2) / q->arity + 1; i-- > 0; ){
+		memcpy(q->tmp, pqslot(q, i), q->v->dtype);
+		pqsift_down(q, i, q->tmp);
+	}
+	return q;
+}
+
+/*
+Changes the member at index 'i' to 'src', and moves it
+up or down to its new position.
+Returns a pointer to its new position.
+*/
+void *pqdecrease_key(pqueue *q, size_t i, const void *src)
+{
+	if(i >= q->v->size)
+		return NULL;
+	memcpy(q->tmp, src, q->v->dtype);
+	if(q->cmp(q->tmp, pqslot(q, i)) < 0)
+		i = pqsift_up(q, i, q->tmp);
+	else
+		i = pqsift_down(q, i, q->tmp);
+	return pqslot(q, i);
+}
@@ -0,0 +1,126 @@
+#ifndef PQUEUE_H
+#define PQUEUE_H 1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../vector/vector.h"
+
+
+/*
+Number of children per node used when none is given.
+Four children halve the depth of a binary heap,
+and the children of a node share one or two cache lines.
+*/
+#define PQUEUE_ARITY 4
+
+
+/*
+Comparison function: returns a negative value if 'a'
+goes before 'b', zero if they are equal, and a positive
+value otherwise, as for qsort.
+The member that goes first is always at the top.
+*/
+typedef int (*pqcmp_fn)(const void *a, const void *b);
+
+
+/*
+Priority queue stored as an implicit d-ary heap
+in the contiguous memory of a vector.
+The children of the member at index 'i' are at indices
+i*arity + 1 to i*arity + arity.
+'tmp' holds the member being moved through the heap.
+*/
+typedef struct pqueueStruct
+{
+	vector *v;
+	size_t arity;
+	pqcmp_fn cmp;
+	void *tmp;
+} pqueue;
+
+
+
+/*
+Allocates new priority queue of members of 'dtype' bytes,
+ordered by 'cmp', with 'arity' children per node,
+and returns pointer to it.
+If 'arity' is zero, PQUEUE_ARITY is used.
+e.g. a min-heap of doubles, and a max-heap:
+	pqueue *q = pqnew(sizeof(double), 0, cmp_ascending);
+	pqueue *q = pqnew(sizeof(double), 2, cmp_descending);
+*/
+pqueue *pqnew(size_t dtype, size_t arity, pqcmp_fn cmp);
+
+/* Frees the priority queue */
+void pqfree(pqueue *q);
+
+/* Returns the number of members in the queue */
+size_t pqsize(pqueue *q);
+
+/* Allocates memory for at least 'n' members */
+pqueue *pqreserve(pqueue *q, size_t n);
+
+/* Removes every member from the queue, keeping its memory */
+pqueue *pqclear(pqueue *q);
+
+/*
+Returns the vector that stores the members in heap order,
+e.g. to read every member. It must not be modified.
+*/
+vector *pqvector(pqueue *q);
+
+/*
+Returns a pointer to the member at index 'i' in heap order,
+or NULL if it is out of range.
+Index zero is the top of the queue.
+*/
+void *pqat(pqueue *q, size_t i);
+
+/* Returns a pointer to the top member, or NULL if the queue is empty */
+void *pqpeek(pqueue *q);
+
+/* Adds a copy of the member 'src' to the queue */
+pqueue *pqpush(pqueue *q, const void *src);
+
+/*
+Removes the top member of the queue.
+If 'dest' is not NULL, the member is copied into it.
+Returns NULL if the queue is empty.
+*/
+pqueue *pqpop(pqueue *q, void *dest);
+
+/*
+Removes the top member and adds 'src' with a single pass
+through the heap, which is faster than pqpop and pqpush.
+If 'dest' is not NULL, the removed member is copied into it.
+If the queue is empty, 'src' is only added.
+e.g. keeping the 'k' largest members of a stream,
+with the smallest at the top:
+	if(pqsize(q) < k)
+		pqpush(q, &x);
+	else if(x > *(double*)pqpeek(q))
+		pqreplace(q, &x, NULL);
+*/
+pqueue *pqreplace(pqueue *q, const void *src, void *dest);
+
+/*
+Replaces the members of the queue with the 'n' members
+of the array 'arr', and orders them in linear time.
+If 'arr' is NULL, the current members are ordered instead,
+e.g. after appending to pqvector.
+*/
+pqueue *pqheapify(pqueue *q, const void *arr, size_t n);
+
+/*
+Changes the member at index 'i' to 'src', and moves it
+to its new position, usually closer to the top
+for a decrease-key. Returns a pointer to its new position,
+or NULL if 'i' is out of range.
+*/
+void *pqdecrease_key(pqueue *q, size_t i, const void *src);
+
+
+
+#endif
@@ -0,0 +1,258 @@
+/*
+	======= slotmap.h =======
+
+	This library provides a new object 'slotmap'
+	that stores members of any data type and structure
+	and identifies them with handles that stay valid
+	while other members are added and removed.
+	Adding, removing and finding members take constant time.
+
+	To create a new slot map, use:
+		slotmap *m = smnew( sizeof(T) );
+	where T is the data type of the members.
+
+	To add a member 'x' and retrieve it later, use:
+		smhandle h = sminsert( m, &x );
+		T *ptr = smget( m, h );
+
+	To remove a member, use:
+		smremove( m, h, NULL );
+
+	To free a slot map, use:
+		smfree(m);
+
+	Members are kept contiguous in a vector, so that they can be
+	iterated over as an array. A table of slots maps handles to
+	positions in that vector. Removed members are replaced by the
+	last member, and their slots are kept in a free list for reuse.
+	Every slot has a generation that grows when it is reused,
+	so handles to removed members never match a new member.
+
+	Requires vector.c to be compiled along with it.
+
+
+
+
+	----- Version History -----
+
+	1.0 - 17/10/2026
+		- Added basic slot map functions:
+		smnew, smfree, smsize, smreserve, smclear,
+		sminsert, smget, smcontains, smremove,
+		smdata, smhandle_at.
+
+
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "slotmap.h"
+
+
+
+//		HANDLES
+
+/* Builds the handle of slot 'i' with generation 'gen' */
+static inline smhandle smmake(uint32_t i, uint32_t gen)
+{
+	return ((smhandle) gen << 32) | i;
+}
+
+/*
+Returns the slot of handle 'h',
+or NULL if it does not match a member
+*/
+static smslot *smfind(slotmap *m, smhandle h)
+{
+	uint32_t i = (uint32_t) h, gen = (uint32_t) (h >> 32);
+	if(i >= vsize(m->slots))
+		return NULL;
+	smslot *s = (smslot*) vdata(m->slots) + i;
+	if(s->gen != gen || !(gen & 1))
+		return NULL;
+	return s;
+}
+
+
+
+//		ALLOCATION
+
+/* Allocates new slot map of members of 'dtype' bytes */
+slotmap *smnew(size_t dtype)
+{
+	slotmap *m = malloc(sizeof(slotmap));
+	if(!m)
+		return NULL;
+	m->data = vnew(dtype);
+	m->owner = vnew(sizeof(uint32_t));
+	m->slots = vnew(sizeof(smslot));
+	if(!m->data || !m->owner || !m->slots){
+		smfree(m);
+		return NULL;
+	}
+	m->free = SLOTMAP_NONE;
+	return m;
+}
+
+/* Frees the slot map */
+void smfree(slotmap *m)
+{
+	if(!m)
+		return;
+	vfree(m->data);
+	vfree(m->owner);
+	vfree(m->slots);
+	free(m);
+}
+
+/* Returns the number of members */
+size_t smsize(slotmap *m)
+{
+	return vsize(m->data);
+}
+
+/* Allocates memory for at least 'n' members */
+slotmap *smreserve(slotmap *m, size_t n)
+{
+	if(!vreserve(m->data, n) || !vreserve(m->owner, n) || !vreserve(m->slots, n))
+		return NULL;
+	return m;
+}
+
+/*
+Removes every member, invalidating every handle.
+Every slot goes back to the free list,
+with its generation moved past its current one.
+*/
+slotmap *smclear(slotmap *m)
+{
+	smslot *s = vdata(m->slots);
+	size_t n = vsize(m->slots);
+	m->free = SLOTMAP_NONE;
+	for(size_t i = n; i-- > 0; ){
+		if(s[i].gen & 1)
+			s[i].gen++;
+		s[i].index = m->free;
+		m->free = (uint32_t) i;
+	}
+	vresize(m->data, 0);
+	vresize(m->owner, 0);
+	return m;
+}
+
+
+
+//		INSERTION AND REMOVAL
+
+/*
+Adds a copy of the member 'src', or an uninitialised member
+if 'src' is NULL, and returns its handle.
+Returns SLOTMAP_NULL on fail.
+*/
+smhandle sminsert(slotmap *m, const void *src)
+{
+	size_t n = vsize(m->data);
+	if(n >= SLOTMAP_NONE)
+		return SLOTMAP_NULL;
+
+	uint32_t i = m->free;
+	int fresh = i == SLOTMAP_NONE;
+	if(fresh){
+		if(vsize(m->slots) >= SLOTMAP_NONE)
+			return SLOTMAP_NULL;
+		smslot *s = vemplace(m->slots);
+		if(!s)
+			return SLOTMAP_NULL;
+		s->gen = 0;
+		i = (uint32_t) (vsize(m->slots) - 1);
+	}
+
+	void *dest = vemplace(m->data);
+	uint32_t *own = dest ? vemplace(m->owner) : NULL;
+	if(!own){
+		if(dest)
+			vpop(m->data, NULL);
+		if(fresh)
+			vpop(m->slots, NULL);
+		return SLOTMAP_NULL;
+	}
+	if(src)
+		memcpy(dest, src, vdtype(m->data));
+	*own = i;
+
+	smslot *s = (smslot*) vdata(m->slots) + i;
+	if(i == m->free)
+		m->free = s->index;
+	s->index = (uint32_t) n;
+	s->gen++;
+	return smmake(i, s->gen);
+}
+
+/* Returns a pointer to the member of handle 'h' */
+void *smget(slotmap *m, smhandle h)
+{
+	smslot *s = smfind(m, h);
+	if(!s)
+		return NULL;
+	return (char*) vdata(m->data) + (size_t) s->index * vdtype(m->data);
+}
+
+/* Returns non-zero if the member of handle 'h' is in the map */
+int smcontains(slotmap *m, smhandle h)
+{
+	return smfind(m, h) != NULL;
+}
+
+/*
+Removes the member of handle 'h', moving the last member
+into its place and updating the slot of the moved member.
+The slot goes to the front of the free list.
+*/
+slotmap *smremove(slotmap *m, smhandle h, void *dest)
+{
+	smslot *s = smfind(m, h);
+	if(!s)
+		return NULL;
+	uint32_t j = s->index;
+	if(dest)
+		memcpy(dest, vat(m->data, j), vdtype(m->data));
+
+	uint32_t *own = vdata(m->owner);
+	uint32_t last = (uint32_t) (vsize(m->data) - 1);
+	if(j != last){
+		smslot *moved = (smslot*) vdata(m->slots) + own[last];
+		moved->index = j;
+		own[j] = own[last];
+	}
+	vswap_remove(m->data, j);
+	vpop(m->owner, NULL);
+
+	//Even generations never match, so SLOTMAP_NULL is never valid
+	s->gen++;
+	s->index = m->free;
+	m->free = (uint32_t) h;
+	return m;
+}
+
+
+
+//		ITERATION
+
+/* Returns the vector that holds the members contiguously */
+vector *smdata(slotmap *m)
+{
+	return m->data;
+}
+
+/* Returns the handle of the member at index 'i' of smdata */
+smhandle smhandle_at(slotmap *m, size_t i)
+{
+	if(i >= vsize(m->owner))
+		return SLOTMAP_NULL;
+	uint32_t k = ((uint32_t*) vdata(m->owner))[i];
+	return smmake(k, ((smslot*) vdata(m->slots))[k].gen);
+}
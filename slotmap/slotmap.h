@@ -0,0 +1,112 @@
+#ifndef SLOTMAP_H
+#define SLOTMAP_H 1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "../vector/vector.h"
+
+
+/*
+Handle to a member of a slot map.
+The lower 32 bits hold the index of its slot, and the upper
+32 bits the generation of the slot when the member was added.
+*/
+typedef uint64_t smhandle;
+
+/* Handle that never refers to a member */
+#define SLOTMAP_NULL ((smhandle) 0)
+
+/* Marks the end of the list of free slots */
+#define SLOTMAP_NONE UINT32_MAX
+
+
+/*
+Slot of a slot map.
+While in use, 'index' is the position of its member in the
+dense vector, otherwise it is the next free slot.
+'gen' is odd while the slot is in use, and grows every time
+the slot is filled or emptied, so that old handles no longer match.
+*/
+typedef struct smslotStruct
+{
+	uint32_t index;
+	uint32_t gen;
+} smslot;
+
+
+/*
+Slot map: members are kept contiguous in 'data', and found
+through a table of slots that never moves them between indices.
+'owner' holds, for every member of 'data', the index of its slot.
+*/
+typedef struct slotmapStruct
+{
+	vector *data;
+	vector *owner;
+	vector *slots;
+	uint32_t free;
+} slotmap;
+
+
+
+/* Allocates new slot map of members of 'dtype' bytes */
+slotmap *smnew(size_t dtype);
+
+/* Frees the slot map */
+void smfree(slotmap *m);
+
+/* Returns the number of members */
+size_t smsize(slotmap *m);
+
+/* Allocates memory for at least 'n' members */
+slotmap *smreserve(slotmap *m, size_t n);
+
+/* Removes every member, invalidating every handle */
+slotmap *smclear(slotmap *m);
+
+/*
+Adds a copy of the member 'src', or an uninitialised member
+if 'src' is NULL, and returns its handle.
+Returns SLOTMAP_NULL on fail.
+*/
+smhandle sminsert(slotmap *m, const void *src);
+
+/*
+Returns a pointer to the member of handle 'h',
+or NULL if it has been removed.
+Pointers are invalidated by insertions and removals,
+while handles stay valid until their member is removed.
+*/
+void *smget(slotmap *m, smhandle h);
+
+/* Returns non-zero if the member of handle 'h' is in the map */
+int smcontains(slotmap *m, smhandle h);
+
+/*
+Removes the member of handle 'h'. The last member is moved
+into its place, so that members stay contiguous.
+If 'dest' is not NULL, the member is copied into it.
+Returns NULL if the handle does not match a member.
+*/
+slotmap *smremove(slotmap *m, smhandle h, void *dest);
+
+/*
+Returns the vector that holds the members contiguously,
+in no particular order, to iterate over them.
+It must not be resized.
+e.g.
+	T *p = vdata(smdata(m));
+	for(size_t i=0; i<smsize(m); i++)
+		process(&p[i], smhandle_at(m, i));
+*/
+vector *smdata(slotmap *m);
+
+/* Returns the handle of the member at index 'i' of smdata */
+smhandle smhandle_at(slotmap *m, size_t i);
+
+
+
+#endif
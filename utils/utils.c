@@ -5,6 +5,7 @@
 #include <string.h>
 #include <math.h>
 #include <stdarg.h>
+#include <stdint.h>
 
 #include "utils.h"
 
@@ -653,6 +654,19 @@ intisval_any(int *arr, size_t len, int val)
 }
 
 
+/*
+Looks for a value in array.
+Sets bit 'i' of 'dest' if arr[i] equals 'val'.
+Note that 'dest' must hold (len + 63) / 64 words.
+*/
+uint64_t *
+intisval_mask(uint64_t *dest, const int *arr, size_t len, int val)
+{
+	ARR_MASK(dest, len, arr, ==, val);
+	return dest;
+}
+
+
 
 
 
@@ -1316,6 +1330,39 @@ fltisnan_subs(double *arr, size_t len, double val)
 }
 
 
+/*
+Looks for NaN values in array.
+Sets bit 'i' of 'dest' if arr[i] is NaN.
+Note that 'dest' must hold (len + 63) / 64 words.
+*/
+uint64_t *
+fltisnan_mask(uint64_t *dest, const double *arr, size_t len)
+{
+	for(size_t i=0; i<len; i+=64){
+		size_t n = len - i < 64 ? len - i : 64;
+		uint64_t w = 0;
+		for(size_t j=0; j<n; j++){
+			w |= (uint64_t)(arr[i+j] != arr[i+j]) << j;
+		}
+		dest[i/64] = w;
+	}
+	return dest;
+}
+
+
+/*
+Looks for a value in array.
+Sets bit 'i' of 'dest' if arr[i] equals 'val'.
+Note that 'dest' must hold (len + 63) / 64 words.
+*/
+uint64_t *
+fltisval_mask(uint64_t *dest, const double *arr, size_t len, double val)
+{
+	ARR_MASK(dest, len, arr, ==, val);
+	return dest;
+}
+
+
 
 
 // ARRAY TYPE CONVERSIONS
@@ -1380,6 +1427,303 @@ flttoint_alloc(const double *arr, size_t len)
 
 
 
+/*
+	ARENA ALLOCATION
+*/
+
+/* Size of the block header, rounded up to keep data aligned */
+#define ARENA_HEADER ((sizeof(arena_block) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+/* Allocates a new empty arena block with 'size' usable bytes */
+static arena_block *
+arena_block_new(size_t size)
+{
+	if(size > SIZE_MAX - ARENA_HEADER)
+		return (NULL);
+	arena_block *b = malloc(ARENA_HEADER + size);
+	if(!b)
+		return (NULL);
+	b->next = NULL;
+	b->size = size;
+	b->used = 0;
+	return b;
+}
+
+/*
+Allocates a new arena that reserves memory
+in blocks of 'block_size' bytes.
+If 'block_size' is zero, ARENA_BLOCK_SIZE is used.
+*/
+arena *
+arena_new(size_t block_size)
+{
+	arena *a = malloc(sizeof(arena));
+	if(!a)
+		return (NULL);
+	a->head = NULL;
+	a->cur = NULL;
+	a->block_size = block_size ? block_size : ARENA_BLOCK_SIZE;
+	return a;
+}
+
+/*
+Returns a pointer to 'bytes' bytes of memory from the arena.
+It must not be freed: it is released by arena_reset or arena_free.
+On fail, it returns NULL.
+*/
+void *
+arena_alloc(arena *a, size_t bytes)
+{
+	if(!a || bytes > SIZE_MAX - ARENA_ALIGN)
+		return (NULL);
+	bytes = (bytes + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+	/* Move on to the next block until one has enough space */
+	arena_block *b = a->cur;
+	while(b && b->size - b->used < bytes){
+		if(!b->next || b->next->used != 0)
+			break;
+		b = b->next;
+	}
+
+	if(!b || b->size - b->used < bytes){
+		/* Add a new block after the current one */
+		size_t size = bytes > a->block_size ? bytes : a->block_size;
+		arena_block *n = arena_block_new(size);
+		if(!n)
+			return (NULL);
+		if(b){
+			n->next = b->next;
+			b->next = n;
+		}
+		else{
+			n->next = a->head;
+			a->head = n;
+		}
+		b = n;
+	}
+
+	a->cur = b;
+	void *ptr = (char *)b + ARENA_HEADER + b->used;
+	b->used += bytes;
+	return ptr;
+}
+
+/*
+Releases every allocation made from the arena at once.
+The blocks are kept to serve later allocations.
+*/
+arena *
+arena_reset(arena *a)
+{
+	if(!a)
+		return (NULL);
+	for(arena_block *b=a->head; b; b=b->next)
+		b->used = 0;
+	a->cur = a->head;
+	return a;
+}
+
+/* Frees the arena and all its memory */
+void
+arena_free(arena *a)
+{
+	if(!a)
+		return;
+	arena_block *b = a->head;
+	while(b){
+		arena_block *next = b->next;
+		free(b);
+		b = next;
+	}
+	free(a);
+}
+
+/* Returns the number of bytes handed out by the arena */
+size_t
+arena_used(const arena *a)
+{
+	size_t used = 0;
+	for(arena_block *b=a->head; b; b=b->next)
+		used += b->used;
+	return used;
+}
+
+
+/*
+The following functions are equivalent to their '_alloc'
+counterparts, but take their memory from an arena.
+*/
+char *
+arena_strcpy(arena *a, const char *str)
+{
+	if(!str)
+		return (NULL);
+	char *t = arena_alloc(a, (strlen(str)+1)*sizeof(char));
+	if(!t)
+		return (NULL);
+	strcpy(t, str);
+	return t;
+}
+
+int *
+arena_intval(arena *a, size_t s, int val)
+{
+	int *arr = arena_alloc(a, s*sizeof(int));
+	if(!arr)
+		return (NULL);
+	return intval(arr, s, val);
+}
+
+int *
+arena_intzeros(arena *a, size_t s)
+{
+	return arena_intval(a, s, 0);
+}
+
+int *
+arena_intones(arena *a, size_t s)
+{
+	return arena_intval(a, s, 1);
+}
+
+int *
+arena_intrange(arena *a, size_t s, int start, int step)
+{
+	int *arr = arena_alloc(a, s*sizeof(int));
+	if(!arr)
+		return (NULL);
+	return intrange(arr, s, start, step);
+}
+
+int *
+arena_intcpy(arena *a, const int *src, size_t s)
+{
+	if(!src)
+		return (NULL);
+	int *dest = arena_alloc(a, s*sizeof(int));
+	if(!dest)
+		return (NULL);
+	return intcpy(dest, src, s);
+}
+
+int *
+arena_intcat(arena *a, const int *x, size_t xs, 
+		const int *y, size_t ys)
+{
+	if(!x || !y)
+		return (NULL);
+	int *dest = arena_alloc(a, (xs+ys)*sizeof(int));
+	if(!dest)
+		return (NULL);
+	return intcat(dest, x, xs, y, ys);
+}
+
+int *
+arena_intins(arena *a, const int *arr, size_t len, size_t index, int val)
+{
+	int *dest = arena_alloc(a, (len+1)*sizeof(int));
+	if(!dest)
+		return (NULL);
+	return intins(dest, arr, len, index, val);
+}
+
+double *
+arena_fltval(arena *a, size_t s, double val)
+{
+	double *arr = arena_alloc(a, s*sizeof(double));
+	if(!arr)
+		return (NULL);
+	return fltval(arr, s, val);
+}
+
+double *
+arena_fltzeros(arena *a, size_t s)
+{
+	return arena_fltval(a, s, 0);
+}
+
+double *
+arena_fltones(arena *a, size_t s)
+{
+	return arena_fltval(a, s, 1);
+}
+
+double *
+arena_fltrange(arena *a, size_t s, double start, double step)
+{
+	double *arr = arena_alloc(a, s*sizeof(double));
+	if(!arr)
+		return (NULL);
+	return fltrange(arr, s, start, step);
+}
+
+double *
+arena_fltcpy(arena *a, const double *src, size_t s)
+{
+	if(!src)
+		return (NULL);
+	double *dest = arena_alloc(a, s*sizeof(double));
+	if(!dest)
+		return (NULL);
+	return fltcpy(dest, src, s);
+}
+
+double *
+arena_fltcat(arena *a, const double *x, size_t xs, 
+		const double *y, size_t ys)
+{
+	if(!x || !y)
+		return (NULL);
+	double *dest = arena_alloc(a, (xs+ys)*sizeof(double));
+	if(!dest)
+		return (NULL);
+	return fltcat(dest, x, xs, y, ys);
+}
+
+double *
+arena_fltdel(arena *a, const double *arr, size_t len, size_t index)
+{
+	if(len == 0)
+		return (NULL);
+	double *dest = arena_alloc(a, (len-1)*sizeof(double));
+	if(!dest)
+		return (NULL);
+	return fltdel(dest, arr, len, index);
+}
+
+double *
+arena_fltins(arena *a, const double *arr, size_t len, size_t index, double val)
+{
+	double *dest = arena_alloc(a, (len+1)*sizeof(double));
+	if(!dest)
+		return (NULL);
+	return fltins(dest, arr, len, index, val);
+}
+
+double *
+arena_inttoflt(arena *a, const int *arr, size_t len)
+{
+	double *dest = arena_alloc(a, len*sizeof(double));
+	if(!dest)
+		return (NULL);
+	return inttoflt(dest, arr, len);
+}
+
+int *
+arena_flttoint(arena *a, const double *arr, size_t len)
+{
+	int *dest = arena_alloc(a, len*sizeof(int));
+	if(!dest)
+		return (NULL);
+	return flttoint(dest, arr, len);
+}
+
+
+
+
+
+
 /*
 	INPUT FUNCTIONS
 */
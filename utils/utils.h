@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <math.h>
 
 
@@ -19,6 +20,7 @@
 	* Memory Management
 	* String Manipulation
 	* 1D number array manipulation
+	* Arena allocation
 	* 2D matrix operations (WIP)
 	* File manipulation (WIP)
 
@@ -86,6 +88,21 @@
 		Added file I/O function: SaveToTxt
 		Renamed functions that return allocated memory from 'A' to '_alloc'.
 
+	1.8 - 17/10/2026
+		Added arena allocator to release many allocations at once:
+			arena_new, arena_alloc, arena_reset, arena_free, arena_used
+		Added arena equivalents of the '_alloc' functions:
+			arena_strcpy, arena_intval, arena_intzeros, arena_intones,
+			arena_intrange, arena_intcpy, arena_intcat, arena_intins,
+			arena_fltval, arena_fltzeros, arena_fltones, arena_fltrange,
+			arena_fltcpy, arena_fltcat, arena_fltdel, arena_fltins,
+			arena_inttoflt, arena_flttoint
+
+	1.9 - 17/10/2026
+		Added ARR_MASK macro and mask functions, which store the results
+		of comparisons as packed bits, one per member:
+			intisval_mask, fltisval_mask, fltisnan_mask
+
 
 	FUTURE PLANS
 
@@ -178,6 +195,25 @@ another value 'sub'.
 		} while(0)\
 
 
+/*
+Same as ARR_WHERE, but the results are saved as
+packed bits in an input array of 64-bit words 'dest',
+where member 'i' is bit 'i % 64' of word 'i / 64'.
+'dest' must hold (len + 63) / 64 words,
+and the bits past 'len' are set to zero.
+*/
+#define ARR_MASK(dest, len, arr, cmp, val) do {\
+			for(size_t _i=0; _i<(len); _i+=64){\
+				size_t _n = (len) - _i < 64 ? (len) - _i : 64;\
+				uint64_t _w = 0;\
+				for(size_t _j=0; _j<_n; _j++){\
+					_w |= (uint64_t)((arr)[_i+_j] cmp (val)) << _j;\
+				}\
+				(dest)[_i/64] = _w;\
+			}\
+		} while(0)\
+
+
 
 //-----------------------------------------
 
@@ -430,6 +466,13 @@ intsmult(int *arr, size_t len, int val);
 int
 intdot(const int *a, const int *b, size_t len);
 
+/*
+Looks for a value in array.
+Sets bit 'i' of 'dest' if arr[i] equals 'val', see ARR_MASK.
+*/
+uint64_t *
+intisval_mask(uint64_t *dest, const int *arr, size_t len, int val);
+
 
 
 
@@ -718,6 +761,22 @@ double *
 fltisnan_subs(double *arr, size_t len, double val);
 
 
+/*
+Looks for NaN values in array.
+Sets bit 'i' of 'dest' if arr[i] is NaN, see ARR_MASK.
+*/
+uint64_t *
+fltisnan_mask(uint64_t *dest, const double *arr, size_t len);
+
+
+/*
+Looks for a value in array.
+Sets bit 'i' of 'dest' if arr[i] equals 'val', see ARR_MASK.
+*/
+uint64_t *
+fltisval_mask(uint64_t *dest, const double *arr, size_t len, double val);
+
+
 
 
 // ARRAY TYPE CONVERSIONS
@@ -750,6 +809,134 @@ flttoint_alloc(const double *arr, size_t len);
 
 
 
+/*
+	ARENA ALLOCATION
+*/
+
+/*
+An arena hands out memory from large blocks by
+moving a pointer forward, so that many small allocations
+can be released at once with arena_reset or arena_free,
+instead of freeing each pointer individually.
+*/
+typedef struct arenaBlockStruct
+{
+	struct arenaBlockStruct *next;
+	size_t size;
+	size_t used;
+} arena_block;
+
+typedef struct arenaStruct
+{
+	arena_block *head;
+	arena_block *cur;
+	size_t block_size;
+} arena;
+
+/* Alignment of every pointer returned by an arena */
+#define ARENA_ALIGN 16
+
+/* Default size of arena blocks, in bytes */
+#define ARENA_BLOCK_SIZE 65536
+
+
+/*
+Allocates a new arena that reserves memory
+in blocks of 'block_size' bytes.
+If 'block_size' is zero, ARENA_BLOCK_SIZE is used.
+*/
+arena *
+arena_new(size_t block_size);
+
+/*
+Returns a pointer to 'bytes' bytes of memory from the arena.
+It must not be freed: it is released by arena_reset or arena_free.
+On fail, it returns NULL.
+*/
+void *
+arena_alloc(arena *a, size_t bytes);
+
+/*
+Releases every allocation made from the arena at once.
+The blocks are kept to serve later allocations.
+*/
+arena *
+arena_reset(arena *a);
+
+/* Frees the arena and all its memory */
+void
+arena_free(arena *a);
+
+/* Returns the number of bytes handed out by the arena */
+size_t
+arena_used(const arena *a);
+
+
+/*
+The following functions are equivalent to their '_alloc'
+counterparts, but take their memory from an arena.
+*/
+char *
+arena_strcpy(arena *a, const char *str);
+
+int *
+arena_intval(arena *a, size_t s, int val);
+
+int *
+arena_intzeros(arena *a, size_t s);
+
+int *
+arena_intones(arena *a, size_t s);
+
+int *
+arena_intrange(arena *a, size_t s, int start, int step);
+
+int *
+arena_intcpy(arena *a, const int *src, size_t s);
+
+int *
+arena_intcat(arena *a, const int *x, size_t xs, 
+		const int *y, size_t ys);
+
+int *
+arena_intins(arena *a, const int *arr, size_t len, size_t index, int val);
+
+double *
+arena_fltval(arena *a, size_t s, double val);
+
+double *
+arena_fltzeros(arena *a, size_t s);
+
+double *
+arena_fltones(arena *a, size_t s);
+
+double *
+arena_fltrange(arena *a, size_t s, double start, double step);
+
+double *
+arena_fltcpy(arena *a, const double *src, size_t s);
+
+double *
+arena_fltcat(arena *a, const double *x, size_t xs, 
+		const double *y, size_t ys);
+
+double *
+arena_fltdel(arena *a, const double *arr, size_t len, size_t index);
+
+double *
+arena_fltins(arena *a, const double *arr, size_t len, size_t index, double val);
+
+double *
+arena_inttoflt(arena *a, const int *arr, size_t len);
+
+int *
+arena_flttoint(arena *a, const double *arr, size_t len);
+
+
+
+
+
+
 /*
 	INPUT FUNCTIONS
 */
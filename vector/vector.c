@@ -12,6 +12,9 @@
 	To insert a new member 'var' at index 0, use:
 		vinsert( v, 0, &var );
 
+	To append a new member 'var' at the end, use:
+		vpush( v, &var );
+
 	To retrieve the current vector size, use:
 		vsize(v);
 
@@ -25,6 +28,11 @@
 	To free a vector, use:
 		vfree(v);
 
+	To create a vector that keeps up to N members
+	without allocating memory, use:
+		VSMALL(T, N) s;
+		vector *v = VSMALL_INIT(s);
+
 	To resize a vector to a given size, use:
 		vresize(v, size);
 
@@ -53,17 +61,203 @@
 	1.2 - 29/10/2020
 		- Added vtovector to convert conventional
 			array to vector
+
+	1.3 - 17/10/2026
+		- Vector now keeps track of its allocated capacity
+			separately from its size, and grows geometrically,
+			so that vinsert no longer reallocates on every call.
+		- Added vreserve and vshrink_to_fit to manage capacity.
+		- vmem now reports the memory actually allocated.
+		- Fixed vresize allocating sizeof(size_t) bytes per member.
+
+	1.4 - 17/10/2026
+		- Added tail operations that skip the shifting
+			done by vinsert: vpush, vpop, vback, vemplace.
+
+	1.5 - 17/10/2026
+		- Added range functions that move memory in a single block:
+			vinsert_range, vappend_array, vdelete_range.
+		- vinsert and vdelete now move the trailing members
+			with a single memmove instead of one member at a time.
+
+	1.6 - 17/10/2026
+		- Added vswap_remove for constant time unordered removal.
+		- Added vremove_if to remove members that satisfy a condition
+			in a single pass.
+
+	1.7 - 17/10/2026
+		- Added VECTOR_DEFINE macro to generate typed,
+			inline functions for a given member type.
+
+	1.8 - 17/10/2026
+		- Added vinit to initialise vectors on the stack
+			or embedded in other structures.
+		- Added vinit_buffer and VSMALL to keep the first
+			members in an inline buffer, only allocating memory
+			once it is outgrown.
+
+	1.9 - 17/10/2026
+		- Added vallocator and vnew_with_allocator to obtain
+			vector memory from custom allocation functions.
+
+	1.10 - 17/10/2026
+		- Added vsort, an in-place introsort.
+		- Added vsort_i32, vsort_u64 and vsort_f64, which use
+			radix sort for large vectors of these types.
+
+	1.11 - 17/10/2026
+		- Added functions for sorted vectors: vlower_bound,
+			vupper_bound, vsorted_insert, vmerge_sorted.
+		- Added veytzinger and veytzinger_search for fast
+			lookups on large read-mostly sorted vectors.
+
+	1.12 - 17/10/2026
+		- Added vdeque, a double-ended queue stored in a ring buffer,
+			with constant time insertion and removal at both ends.
+
+	1.13 - 17/10/2026
+		- Added svector, a segmented vector stored in fixed-size
+			chunks, whose members never move in memory.
+
+	1.14 - 17/10/2026
+		- Added file-backed vectors, whose data is a mapping of a file:
+			vnew_mapped, vopen_mapped, vsync.
+
+	1.15 - 17/10/2026
+		- Added binary files for vectors: vsave, vload.
+		- Added vload_view to map a saved vector without copying it.
+
+	1.16 - 17/10/2026
+		- Added concurrent append mode, where threads append with
+			vpush_concurrent, claiming slots with an atomic counter:
+			vconcurrent_begin,
+			vpush_concurrent, vsize_concurrent, vat_concurrent,
+			vconcurrent_end.
+
+	1.17 - 17/10/2026
+		- Added thread pools, vpool, to split vector operations
+			in chunks across threads.
+		- Added vfor_each, vmap, vreduce and vfill_parallel,
+			which run serially or on a thread pool.
+
+	1.18 - 17/10/2026
+		- vfill now writes the member once and doubles it with
+			growing blocks, with fast paths for zero members
+			and for members of 1, 2, 4 and 8 bytes.
+
+	1.19 - 17/10/2026
+		- Added vbegin, vend and the macro VFOREACH to loop
+			over vectors through typed pointers.
+
+	1.20 - 17/10/2026
+		- Added vsoa, a struct of arrays that stores each field
+			of its records in its own column.
+
+	1.21 - 17/10/2026
+		- Added vnew_aligned for vectors whose data keeps
+			an alignment and tail padding when it grows.
+
+	1.22 - 17/10/2026
+		- Added vadopt and vrelease to hand arrays to and from
+			vectors without copying them.
+		- Added vslice, a view of a range of members with a stride,
+			with vslice_of, vslice_step, vslice_array, vslsize,
+			vslcontiguous, vslat, vslcopy, vsllower_bound,
+			vslupper_bound, vslfor_each and vslreduce.
 			
 
 
 */
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 
 #include "vector.h"
 
+#if defined(__unix__) || defined(__APPLE__)
+#define VECTOR_MMAP 1
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sched.h>
+#include <pthread.h>
+#define VECTOR_THREADS 1
+#endif
+
+#if !defined(__STDC_NO_ATOMICS__) && __STDC_VERSION__ >= 201112L
+#define VECTOR_ATOMICS 1
+#include <stdatomic.h>
+#endif
+
+
+/* Vector object was not allocated by vnew */
+#define VFLAG_EMBEDDED 0x1
+
+/* Data lives in a buffer owned by the caller */
+#define VFLAG_INLINE 0x2
+
+/* Data is a mapping of a file */
+#define VFLAG_MAPPED 0x4
+
+/* Data is a private mapping of a file, never written back */
+#define VFLAG_VIEW 0x8
+
+/* Data starts at an alignment inside a larger block, 'raw' */
+#define VFLAG_ALIGNED 0x10
+
+static vector *vmap_resize(vector *v, size_t cap);
+static void vmap_close(vector *v);
+
+
+
+//		ALLOCATION
+
+/*
+The following functions forward memory requests
+to the allocator 'a', or to the standard library if it is NULL.
+*/
+static void *vraw_alloc(const vallocator *a, size_t bytes)
+{
+	if(!a)
+		return malloc(bytes);
+	return a->malloc_fn(a->ctx, bytes);
+}
+
+static void *vraw_realloc(const vallocator *a, void *ptr,
+			size_t old_bytes, size_t new_bytes)
+{
+	if(!a)
+		return realloc(ptr, new_bytes);
+	if(a->realloc_fn)
+		return a->realloc_fn(a->ctx, ptr, old_bytes, new_bytes);
+
+	//Allocator cannot resize in place: move to a new block
+	void *d = a->malloc_fn(a->ctx, new_bytes);
+	if(!d)
+		return NULL;
+	if(ptr){
+		memcpy(d, ptr, old_bytes < new_bytes ? old_bytes : new_bytes);
+		a->free_fn(a->ctx, ptr, old_bytes);
+	}
+	return d;
+}
+
+static void vraw_free(const vallocator *a, void *ptr, size_t bytes)
+{
+	if(!a){
+		free(ptr);
+		return;
+	}
+	if(ptr)
+		a->free_fn(a->ctx, ptr, bytes);
+}
 
 
 
@@ -72,16 +266,224 @@ Allocates new vector and returns pointer to it
 */
 vector *vnew(size_t bytes)
 {
-	vector *v = malloc(sizeof(vector));
+	return vnew_with_allocator(bytes, NULL);
+}
+
+/*
+Allocates new vector that obtains all its memory,
+including the vector object, from the allocator 'a'.
+The allocator must outlive the vector.
+If 'a' is NULL, the standard library is used.
+*/
+vector *vnew_with_allocator(size_t bytes, const vallocator *a)
+{
+	vector *v = vraw_alloc(a, sizeof(vector));
+	if(!v)
+		return NULL;
+	vinit(v, bytes);
+	v->flags = 0;
+	v->alloc = a;
+
+	return v;
+}
+
+/*
+Allocates new vector whose data starts at a multiple of
+'align' bytes, followed by 'pad' bytes past its capacity.
+The data is kept inside a larger block, 'raw', with room
+to align its start and to hold the padding.
+*/
+vector *vnew_aligned(size_t bytes, size_t align, size_t pad)
+{
+	if(align == 0)
+		align = VECTOR_CACHE_LINE;
+	if(align & (align - 1))
+		return NULL;
+	vector *v = vnew(bytes);
 	if(!v)
 		return NULL;
+	v->flags |= VFLAG_ALIGNED;
+	v->align = align;
+	v->pad = pad;
+	return v;
+}
+
+/*
+Initialises a vector object provided by the caller,
+e.g. on the stack or inside another structure.
+It must still be freed with vfree.
+*/
+vector *vinit(vector *v, size_t bytes)
+{
 	v->d = NULL;
 	v->size = 0;
 	v->dtype = bytes;
+	v->capacity = 0;
+	v->flags = VFLAG_EMBEDDED;
+	v->alloc = NULL;
+	v->map = NULL;
+	v->conc = NULL;
+	v->raw = NULL;
+	v->align = 0;
+	v->pad = 0;
+	return v;
+}
+
+/*
+Initialises a vector object provided by the caller
+that stores its first 'n' members in the buffer 'buf'.
+Memory is only allocated once the vector grows past 'n' members.
+*/
+vector *vinit_buffer(vector *v, size_t bytes, void *buf, size_t n)
+{
+	vinit(v, bytes);
+	v->d = buf;
+	v->capacity = n;
+	v->flags |= VFLAG_INLINE;
+	return v;
+}
+
+
+//		CAPACITY
+
+/* Size of the raw block of an aligned vector of 'cap' members */
+static size_t valigned_bytes(vector *v, size_t cap)
+{
+	return cap*v->dtype + v->pad + v->align - 1;
+}
+
+/*
+Changes the allocated memory of an aligned vector.
+The block is resized in place when possible, after which
+the members are moved if their alignment offset changed.
+*/
+static vector *valigned_realloc(vector *v, size_t cap)
+{
+	size_t old_bytes = v->raw ? valigned_bytes(v, v->capacity) : 0;
+	if(cap == 0){
+		vraw_free(v->alloc, v->raw, old_bytes);
+		v->raw = NULL;
+		v->d = NULL;
+		v->capacity = 0;
+		return v;
+	}
+	if(v->dtype && cap > (SIZE_MAX - v->pad - v->align) / v->dtype)
+		return NULL;
+
+	size_t old_off = v->raw ? (size_t)((char*)v->d - (char*)v->raw) : 0;
+	char *raw = vraw_realloc(v->alloc, v->raw, old_bytes, valigned_bytes(v, cap));
+	if(!raw)
+		return NULL;
+	uintptr_t a = ((uintptr_t)raw + v->align - 1) & ~(uintptr_t)(v->align - 1);
+	char *d = raw + (a - (uintptr_t)raw);
+	if(v->raw && d != raw + old_off){
+		size_t n = v->size < cap ? v->size : cap;
+		memmove(d, raw + old_off, n*v->dtype);
+	}
+	memset(d + cap*v->dtype, 0, v->pad);
+	v->raw = raw;
+	v->d = d;
+	v->capacity = cap;
+	return v;
+}
 
+/*
+Changes the allocated memory of the vector
+to hold exactly 'cap' members.
+The vector is left untouched on fail.
+*/
+static vector *vrealloc(vector *v, size_t cap)
+{
+	if(v->flags & VFLAG_MAPPED)
+		return vmap_resize(v, cap);
+
+	//The inline buffer cannot shrink, and is copied once outgrown
+	if(v->flags & VFLAG_INLINE){
+		if(cap <= v->capacity)
+			return v;
+		if(v->dtype && cap > SIZE_MAX / v->dtype)
+			return NULL;
+		void *d = vraw_alloc(v->alloc, cap*v->dtype);
+		if(!d)
+			return NULL;
+		memcpy(d, v->d, v->size*v->dtype);
+		v->d = d;
+		v->capacity = cap;
+		v->flags &= ~VFLAG_INLINE;
+		return v;
+	}
+
+	if(v->flags & VFLAG_ALIGNED)
+		return valigned_realloc(v, cap);
+
+	if(cap == 0){
+		vraw_free(v->alloc, v->d, v->capacity*v->dtype);
+		v->d = NULL;
+		v->capacity = 0;
+		return v;
+	}
+	if(v->dtype && cap > SIZE_MAX / v->dtype)
+		return NULL;
+	void *d = vraw_realloc(v->alloc, v->d,
+				v->capacity*v->dtype, cap*v->dtype);
+	if(!d)
+		return NULL;
+	v->d = d;
+	v->capacity = cap;
 	return v;
 }
 
+/*
+Ensures there is space for at least 'mincap' members,
+growing the capacity geometrically so that repeated
+insertions take amortised constant time.
+*/
+static vector *vgrow(vector *v, size_t mincap)
+{
+	if(mincap <= v->capacity)
+		return v;
+	size_t cap = v->capacity ? v->capacity : VECTOR_MIN_CAPACITY;
+	while(cap < mincap){
+		if(cap > SIZE_MAX / VECTOR_GROWTH){
+			cap = mincap;
+			break;
+		}
+		cap *= VECTOR_GROWTH;
+	}
+	return vrealloc(v, cap);
+}
+
+/*
+Returns the number of members the vector
+can hold without reallocating
+*/
+size_t vcapacity(vector *v)
+{
+	return v->capacity;
+}
+
+/*
+Allocates memory for at least 'n' members,
+without changing the size of the vector.
+*/
+vector *vreserve(vector *v, size_t n)
+{
+	if(n <= v->capacity)
+		return v;
+	return vrealloc(v, n);
+}
+
+/*
+Frees the unused allocated memory,
+so that capacity equals size.
+*/
+vector *vshrink_to_fit(vector *v)
+{
+	if(v->capacity == v->size)
+		return v;
+	return vrealloc(v, v->size);
+}
+
 
 //		GETTERS
 
@@ -127,15 +529,21 @@ void *vat(vector *v, size_t i)
 
 
 /*
-Returns the total memory allocated for the vector
+Returns the heap memory allocated for the vector,
+branching on its storage in the same way as vfree
 */
 size_t vmem(vector *v)
 {
 	if(!v)
 		return 0;
-	if(vsize(v)==0)
-		return sizeof(vector); 
-	return sizeof(vector)+vsize(v)*vdtype(v);
+	size_t bytes = v->flags & VFLAG_EMBEDDED ? 0 : sizeof(vector);
+	if(v->flags & VFLAG_MAPPED)
+		return bytes;
+	if(v->flags & VFLAG_ALIGNED)
+		return bytes + (v->raw ? valigned_bytes(v, v->capacity) : 0);
+	if(v->flags & VFLAG_INLINE)
+		return bytes;
+	return bytes + v->capacity*v->dtype;
 }
 
 
@@ -153,14 +561,72 @@ vector *vset(vector *v, size_t i, void *src)
 	return v;
 }
 
+/*
+Writes 'n' copies of the member 'src' of 'dt' bytes into 'd'.
+Members of all zero bytes are written with memset, and members
+of 2, 4 and 8 bytes with typed stores. Other sizes are written
+once and then doubled with growing memcpy blocks, which are
+capped at VECTOR_FILL_BLOCK bytes so that the source stays in cache.
+*/
+static void vfill_range(char *d, size_t n, size_t dt, const void *src)
+{
+	if(!n)
+		return;
+	const unsigned char *b = src;
+	size_t k = 0;
+	while(k < dt && !b[k])
+		k++;
+	if(k == dt || dt == 1){
+		memset(d, b[0], n*dt);
+		return;
+	}
+
+	switch(dt){
+	case 2: {
+		uint16_t x;
+		memcpy(&x, src, 2);
+		for(size_t i=0; i<n; i++)
+			memcpy(d + i*2, &x, 2);
+		return;
+	}
+	case 4: {
+		uint32_t x;
+		memcpy(&x, src, 4);
+		for(size_t i=0; i<n; i++)
+			memcpy(d + i*4, &x, 4);
+		return;
+	}
+	case 8: {
+		uint64_t x;
+		memcpy(&x, src, 8);
+		for(size_t i=0; i<n; i++)
+			memcpy(d + i*8, &x, 8);
+		return;
+	}
+	}
+
+	size_t total = n*dt;
+	size_t block = VECTOR_FILL_BLOCK / dt * dt;
+	if(!block)
+		block = dt;
+	memcpy(d, src, dt);
+	size_t done = dt;
+	while(done < total){
+		size_t len = done < block ? done : block;
+		if(len > total - done)
+			len = total - done;
+		memcpy(d + done, d, len);
+		done += len;
+	}
+}
+
 /*
 Substitutes every member in the vector with
 the input member
 */
 vector *vfill(vector *v, void *src)
 {
-	for(size_t i=0; i<vsize(v); i++)
-		vset(v, i, src);
+	vfill_range(v->d, v->size, v->dtype, src);
 	return v;
 }
 
@@ -174,85 +640,226 @@ at index 'j'.
 */
 vector *vinsert(vector *v, size_t j, void *new)
 {
-	if(j > vsize(v))
-		return NULL;
+	return vinsert_range(v, j, new, 1);
+}
 
-	//Reallocate with one extra space
-	v->d = realloc(v->d, v->dtype*(v->size+1) );
-	if(v->d == NULL)
+/*
+Inserts 'n' members from the array 'src'
+into the vector at index 'j'.
+The array may point into the vector itself.
+*/
+vector *vinsert_range(vector *v, size_t j, const void *src, size_t n)
+{
+	if(j > vsize(v) || n > SIZE_MAX - v->size)
 		return NULL;
-	v->size++;
+	if(n == 0)
+		return v;
+
+	size_t bytes = n*v->dtype;
+	size_t pos = j*v->dtype;
+	size_t used = v->size*v->dtype;
 
-	//Shift values forward from insert index
-	for(size_t i=vsize(v)-1; i>j; i--)
-	{
-		void *dest = vat(v, i);
-		void *src = vat(v, i-1);
-		memcpy(dest, src, v->dtype);
+	//Check if the source lives in the vector, as it may be moved
+	int alias = 0;
+	size_t off = 0;
+	if(v->d && (uintptr_t)src >= (uintptr_t)v->d
+		&& (uintptr_t)src < (uintptr_t)v->d + used){
+		alias = 1;
+		off = (uintptr_t)src - (uintptr_t)v->d;
 	}
 
+	//Make room for the new members
+	if(!vgrow(v, v->size+n))
+		return NULL;
+	char *d = v->d;
+
+	//Shift values forward from insert index in a single move
+	memmove(d + pos + bytes, d + pos, used - pos);
+	v->size += n;
+
 	//Copy new member data from input pointer
-	void *dest = vat(v, j);
-	memcpy(dest, new, v->dtype);
+	if(!alias)
+		memcpy(d + pos, src, bytes);
+	else if(off + bytes <= pos)
+		memcpy(d + pos, d + off, bytes);
+	else if(off >= pos)
+		memcpy(d + pos, d + off + bytes, bytes);
+	else{
+		memcpy(d + pos, d + off, pos - off);
+		memcpy(d + pos + (pos - off), d + pos + bytes, off + bytes - pos);
+	}
 
 	return v;
 }
 
+/*
+Appends 'n' members from the array 'src'
+at the end of the vector.
+*/
+vector *vappend_array(vector *v, const void *src, size_t n)
+{
+	return vinsert_range(v, vsize(v), src, n);
+}
+
 /*
 Deletes member 'i' from vector
 */
 vector *vdelete(vector *v, size_t i)
 {
-	if(i >= vsize(v))
+	return vdelete_range(v, i, 1);
+}
+
+/*
+Deletes 'n' members from vector
+starting at index 'i'.
+*/
+vector *vdelete_range(vector *v, size_t i, size_t n)
+{
+	if(i >= vsize(v) || n > vsize(v) - i)
 		return NULL;
 
-	//If there is only one member to delete, free instead
-	if(v->size == 1){
-		free(v->d);
-		v->size--;
-		return v;
+	//Shift memory back over deleted members in a single move
+	char *d = v->d;
+	size_t tail = (v->size - i - n)*v->dtype;
+	memmove(d + i*v->dtype, d + (i+n)*v->dtype, tail);
+
+	//Memory is kept for later use, see vshrink_to_fit
+	v->size -= n;
+	return v;
+}
+
+/*
+Deletes member 'i' from vector by moving
+the last member into its place.
+The order of the members is not preserved.
+*/
+vector *vswap_remove(vector *v, size_t i)
+{
+	if(i >= vsize(v))
+		return NULL;
+	v->size--;
+	if(i != v->size){
+		char *d = v->d;
+		memcpy(d + i*v->dtype, d + v->size*v->dtype, v->dtype);
 	}
+	return v;
+}
+
+/*
+Deletes every member for which 'pred' returns non-zero,
+keeping the order of the remaining members.
+The argument 'ctx' is passed on to 'pred'.
+*/
+vector *vremove_if(vector *v, int (*pred)(void *, void *), void *ctx)
+{
+	char *d = v->d;
+	size_t dt = v->dtype;
+	size_t keep = 0;
 
-	//Shift memory back over deleted member
-	for(size_t j=i; j<vsize(v)-1; j++){
-		void *src = vat(v, j+1);
-		void *dest = vat(v, j);
-		memcpy(dest, src, v->dtype);
+	//Compact the surviving members in a single pass
+	for(size_t i=0; i<v->size; i++){
+		char *src = d + i*dt;
+		if(pred(src, ctx))
+			continue;
+		if(keep != i)
+			memcpy(d + keep*dt, src, dt);
+		keep++;
 	}
 
-	//Reallocate to reduce memory usage	
-	v->d = realloc(v->d, v->dtype*(v->size-1) );	
-	v->size--;
-	if(!v->d)
+	v->size = keep;
+	return v;
+}
+
+/*
+Appends a new member at the end of the vector.
+*/
+vector *vpush(vector *v, void *new)
+{
+	if(v->size == v->capacity && !vgrow(v, v->size+1))
 		return NULL;
+	memcpy((char*)v->d + v->size*v->dtype, new, v->dtype);
+	v->size++;
+	return v;
+}
 
+/*
+Removes the last member of the vector.
+If 'dest' is not NULL, the member is copied into it.
+*/
+vector *vpop(vector *v, void *dest)
+{
+	if(v->size == 0)
+		return NULL;
+	v->size--;
+	if(dest)
+		memcpy(dest, (char*)v->d + v->size*v->dtype, v->dtype);
 	return v;
 }
 
+/*
+Returns a pointer to the last member of the vector,
+or NULL if it is empty.
+*/
+void *vback(vector *v)
+{
+	if(v->size == 0)
+		return NULL;
+	return (char*)v->d + (v->size-1)*v->dtype;
+}
+
+/*
+Appends a new uninitialised member at the end of the vector,
+and returns a pointer to it so that it can be written in place.
+*/
+void *vemplace(vector *v)
+{
+	if(v->size == v->capacity && !vgrow(v, v->size+1))
+		return NULL;
+	void *ptr = (char*)v->d + v->size*v->dtype;
+	v->size++;
+	return ptr;
+}
+
 /*
 Changes the size of a vector directly.
 Increasing the size will generate new empty members,
 and reducing it will erase extra members.
+Reducing the size does not free memory.
 */
 vector *vresize(vector *v, size_t newsize)
 {
-	v->d = realloc(v->d, sizeof(v->dtype)*newsize);
-	if(v->d == NULL)
+	if(!vreserve(v, newsize))
 		return NULL;
 	v->size = newsize;
 	return v;
 }
 
 /*
-Frees the vector
+Frees the vector.
+Vectors initialised with vinit only have their data freed.
+File-backed vectors save their size and close their file.
 */
 void vfree(vector *v)
 {
 	if(!v){
 		return;
 	}
-	free(v->d);
-	free(v);
+	if(v->conc)
+		vconcurrent_end(v);
+	if(v->flags & VFLAG_MAPPED)
+		vmap_close(v);
+	else if(v->flags & VFLAG_ALIGNED)
+		valigned_realloc(v, 0);
+	else if(!(v->flags & VFLAG_INLINE))
+		vraw_free(v->alloc, v->d, v->capacity*v->dtype);
+	if(v->flags & VFLAG_EMBEDDED){
+		v->d = NULL;
+		v->size = 0;
+		v->capacity = 0;
+		v->flags = VFLAG_EMBEDDED;
+		return;
+	}
+	vraw_free(v->alloc, v, sizeof(vector));
 }
 
 
@@ -262,7 +869,2269 @@ Converts an array into a vector
 vector *vtovector(void *arr, size_t elem_num, size_t elem_size)
 {
 	vector *v = vnew(elem_size);
-	vresize(v, elem_num);
+	if(!v)
+		return NULL;
+	if(!vresize(v, elem_num)){
+		vfree(v);
+		return NULL;
+	}
 	memcpy(vdata(v), arr, elem_num*elem_size);
 	return v;
-}
\ No newline at end of file
+}
+
+/*
+Converts an array allocated with malloc into a vector
+without copying it. The vector takes ownership of the array.
+*/
+vector *vadopt(void *arr, size_t elem_num, size_t elem_size)
+{
+	vector *v = vnew(elem_size);
+	if(!v)
+		return NULL;
+	v->d = arr;
+	v->size = elem_num;
+	v->capacity = elem_num;
+	return v;
+}
+
+/*
+Frees the vector, except for its data, which is returned
+without copying it.
+*/
+void *vrelease(vector *v)
+{
+	if(v->conc || (v->flags & (VFLAG_MAPPED|VFLAG_INLINE|VFLAG_ALIGNED)))
+		return NULL;
+	void *d = v->d;
+	v->d = NULL;
+	v->capacity = 0;
+	vfree(v);
+	return d;
+}
+
+
+
+//		SORTING
+
+/* Swaps two members of 'dt' bytes */
+static inline void vswap_members(char *a, char *b, size_t dt)
+{
+	switch(dt){
+	case 4:{
+		uint32_t t;
+		memcpy(&t, a, 4); memcpy(a, b, 4); memcpy(b, &t, 4);
+		return;
+	}
+	case 8:{
+		uint64_t t;
+		memcpy(&t, a, 8); memcpy(a, b, 8); memcpy(b, &t, 8);
+		return;
+	}
+	default:
+		for(size_t k=0; k<dt; k++){
+			char t = a[k];
+			a[k] = b[k];
+			b[k] = t;
+		}
+	}
+}
+
+/* Sorts a small range of 'n' members by insertion */
+static void vsort_insertion(char *d, size_t n, size_t dt,
+			int (*cmp)(const void *, const void *))
+{
+	for(size_t i=1; i<n; i++){
+		for(size_t j=i; j>0; j--){
+			char *a = d + (j-1)*dt;
+			if(cmp(a, a+dt) <= 0)
+				break;
+			vswap_members(a, a+dt, dt);
+		}
+	}
+}
+
+/* Moves member 'i' down the max-heap of 'n' members */
+static void vsort_sift(char *d, size_t i, size_t n, size_t dt,
+			int (*cmp)(const void *, const void *))
+{
+	for(;;){
+		size_t c = 2*i + 1;
+		if(c >= n)
+			return;
+		if(c+1 < n && cmp(d + c*dt, d + (c+1)*dt) < 0)
+			c++;
+		if(cmp(d + i*dt, d + c*dt) >= 0)
+			return;
+		vswap_members(d + i*dt, d + c*dt, dt);
+		i = c;
+	}
+}
+
+/* Sorts a range of 'n' members with heapsort */
+static void vsort_heap(char *d, size_t n, size_t dt,
+			int (*cmp)(const void *, const void *))
+{
+	for(size_t i=n/2; i>0; i--)
+		vsort_sift(d, i-1, n, dt, cmp);
+	for(size_t i=n-1; i>0; i--){
+		vswap_members(d, d + i*dt, dt);
+		vsort_sift(d, 0, i, dt, cmp);
+	}
+}
+
+/*
+Sorts a range of 'n' members with quicksort,
+switching to heapsort once 'depth' runs out
+and to insertion sort for small ranges.
+*/
+static void vsort_intro(char *d, size_t n, size_t dt, size_t depth,
+			int (*cmp)(const void *, const void *))
+{
+	while(n > VECTOR_SORT_SMALL){
+		if(depth == 0){
+			vsort_heap(d, n, dt, cmp);
+			return;
+		}
+		depth--;
+
+		//Median of three pivot, moved to the front
+		char *lo = d, *mid = d + (n/2)*dt, *hi = d + (n-1)*dt;
+		if(cmp(mid, lo) < 0)
+			vswap_members(mid, lo, dt);
+		if(cmp(hi, mid) < 0){
+			vswap_members(hi, mid, dt);
+			if(cmp(mid, lo) < 0)
+				vswap_members(mid, lo, dt);
+		}
+		vswap_members(lo, mid, dt);
+
+		//Hoare partition around the pivot at 'lo'
+		size_t i = 0, j = n;
+		for(;;){
+			do i++; while(i < n && cmp(d + i*dt, lo) < 0);
+			do j--; while(cmp(d + j*dt, lo) > 0);
+			if(i >= j)
+				break;
+			vswap_members(d + i*dt, d + j*dt, dt);
+		}
+		vswap_members(lo, d + j*dt, dt);
+
+		//Recurse on the smaller side to bound the stack
+		size_t left = j, right = n - j - 1;
+		if(left < right){
+			vsort_intro(d, left, dt, depth, cmp);
+			d += (j+1)*dt;
+			n = right;
+		}
+		else{
+			vsort_intro(d + (j+1)*dt, right, dt, depth, cmp);
+			n = left;
+		}
+	}
+	vsort_insertion(d, n, dt, cmp);
+}
+
+/*
+Sorts the vector in place in the order given
+by the comparison function 'cmp', which behaves
+as the one taken by qsort.
+*/
+vector *vsort(vector *v, int (*cmp)(const void *, const void *))
+{
+	size_t depth = 0;
+	for(size_t n=v->size; n>1; n>>=1)
+		depth += 2;
+	if(v->size > 1)
+		vsort_intro(v->d, v->size, v->dtype, depth, cmp);
+	return v;
+}
+
+
+/* Kinds of keys sorted by radix sort */
+enum { VRADIX_I32, VRADIX_U64, VRADIX_F64 };
+
+/*
+Returns the unsigned key of a member, which sorts
+in the same order as the member itself
+*/
+static inline uint64_t vradix_key(const char *p, int kind)
+{
+	if(kind == VRADIX_I32){
+		uint32_t u;
+		memcpy(&u, p, 4);
+		return u ^ 0x80000000u;
+	}
+	uint64_t u;
+	memcpy(&u, p, 8);
+	if(kind == VRADIX_F64){
+		//Negative values have all bits flipped, positive only the sign
+		uint64_t mask = (uint64_t)-(int64_t)(u >> 63) | 0x8000000000000000u;
+		return u ^ mask;
+	}
+	return u;
+}
+
+/*
+Sorts the vector with a least significant digit radix sort,
+one byte per pass, using a scratch buffer of the same size.
+Passes where every member has the same digit are skipped.
+*/
+static inline vector *vsort_radix(vector *v, int kind)
+{
+	size_t n = v->size;
+	size_t dt = kind == VRADIX_I32 ? 4 : 8;
+	char *src = v->d;
+	char *tmp = vraw_alloc(v->alloc, n*dt);
+	if(!tmp)
+		return NULL;
+
+	//Count the digits of every pass at once
+	size_t count[8][256] = {{0}};
+	for(size_t i=0; i<n; i++){
+		uint64_t k = vradix_key(src + i*dt, kind);
+		for(size_t b=0; b<dt; b++)
+			count[b][(k >> 8*b) & 0xff]++;
+	}
+
+	char *dst = tmp;
+	for(size_t b=0; b<dt; b++){
+		size_t *c = count[b];
+		if(c[vradix_key(src, kind) >> 8*b & 0xff] == n)
+			continue;
+		size_t sum = 0;
+		for(size_t k=0; k<256; k++){
+			size_t t = c[k];
+			c[k] = sum;
+			sum += t;
+		}
+		for(size_t i=0; i<n; i++){
+			const char *p = src + i*dt;
+			memcpy(dst + c[(vradix_key(p, kind) >> 8*b) & 0xff]++ * dt, p, dt);
+		}
+		char *t = src;
+		src = dst;
+		dst = t;
+	}
+
+	//Result may have ended in the scratch buffer
+	if(src != v->d)
+		memcpy(v->d, src, n*dt);
+	vraw_free(v->alloc, tmp, n*dt);
+	return v;
+}
+
+static int vcmp_i32(const void *a, const void *b)
+{
+	int32_t x = *(const int32_t *)a, y = *(const int32_t *)b;
+	return (x > y) - (x < y);
+}
+
+static int vcmp_u64(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+	return (x > y) - (x < y);
+}
+
+static int vcmp_f64(const void *a, const void *b)
+{
+	uint64_t x = vradix_key(a, VRADIX_F64), y = vradix_key(b, VRADIX_F64);
+	return (x > y) - (x < y);
+}
+
+/*
+Sorts a vector of 32-bit signed integers in ascending order,
+using radix sort for large vectors.
+Returns NULL if the members are not 4 bytes long.
+*/
+vector *vsort_i32(vector *v)
+{
+	if(v->dtype != sizeof(int32_t))
+		return NULL;
+	if(v->size < VECTOR_RADIX_MIN || !vsort_radix(v, VRADIX_I32))
+		return vsort(v, vcmp_i32);
+	return v;
+}
+
+/*
+Sorts a vector of 64-bit unsigned integers in ascending order,
+using radix sort for large vectors.
+Returns NULL if the members are not 8 bytes long.
+*/
+vector *vsort_u64(vector *v)
+{
+	if(v->dtype != sizeof(uint64_t))
+		return NULL;
+	if(v->size < VECTOR_RADIX_MIN || !vsort_radix(v, VRADIX_U64))
+		return vsort(v, vcmp_u64);
+	return v;
+}
+
+/*
+Sorts a vector of doubles in ascending order,
+using radix sort for large vectors.
+Negative zero is placed before zero, and NaN values
+are placed at either end depending on their sign.
+Returns NULL if the members are not doubles.
+*/
+vector *vsort_f64(vector *v)
+{
+	if(v->dtype != sizeof(double))
+		return NULL;
+	if(v->size < VECTOR_RADIX_MIN || !vsort_radix(v, VRADIX_F64))
+		return vsort(v, vcmp_f64);
+	return v;
+}
+
+
+
+//		SORTED VECTORS
+
+/*
+Returns the index of the first member that does not
+compare less than 'key', or the size of the vector if
+there is none. The vector must be sorted by 'cmp'.
+*/
+size_t vlower_bound(vector *v, const void *key,
+			int (*cmp)(const void *, const void *))
+{
+	return vsllower_bound(vslice_of(v, 0, v->size), key, cmp);
+}
+
+/*
+Returns the index of the first member that compares
+greater than 'key', or the size of the vector if
+there is none. The vector must be sorted by 'cmp'.
+*/
+size_t vupper_bound(vector *v, const void *key,
+			int (*cmp)(const void *, const void *))
+{
+	return vslupper_bound(vslice_of(v, 0, v->size), key, cmp);
+}
+
+/*
+Inserts a new member into a vector sorted by 'cmp',
+after any members that compare equal to it.
+*/
+vector *vsorted_insert(vector *v, void *new,
+			int (*cmp)(const void *, const void *))
+{
+	return vinsert(v, vupper_bound(v, new, cmp), new);
+}
+
+/*
+Merges the 'n' members of the array 'src' into the vector,
+both sorted by 'cmp', so that the vector remains sorted.
+Members of the vector are placed before equal members of 'src'.
+The array must not point into the vector.
+*/
+vector *vmerge_sorted(vector *v, const void *src, size_t n,
+			int (*cmp)(const void *, const void *))
+{
+	if(n > SIZE_MAX - v->size)
+		return NULL;
+	if(!vgrow(v, v->size + n))
+		return NULL;
+
+	//Merge from the back, so no member is overwritten before it is moved
+	size_t dt = v->dtype;
+	char *d = v->d;
+	const char *s = src;
+	size_t i = v->size, j = n, k = v->size + n;
+	while(j > 0){
+		if(i > 0 && cmp(d + (i-1)*dt, s + (j-1)*dt) > 0)
+			memcpy(d + (--k)*dt, d + (--i)*dt, dt);
+		else
+			memcpy(d + (--k)*dt, s + (--j)*dt, dt);
+	}
+
+	v->size += n;
+	return v;
+}
+
+/* Fills the subtree rooted at 'k' of the Eytzinger layout in order */
+static size_t veytzinger_fill(const char *src, char *dst, size_t i,
+			size_t k, size_t n, size_t dt)
+{
+	if(k > n)
+		return i;
+	i = veytzinger_fill(src, dst, i, 2*k, n, dt);
+	memcpy(dst + (k-1)*dt, src + i*dt, dt);
+	i++;
+	return veytzinger_fill(src, dst, i, 2*k+1, n, dt);
+}
+
+/*
+Returns a new vector with the members of the sorted vector 'v'
+in Eytzinger layout, where the children of member 'k' are at
+2k+1 and 2k+2. Searching it with veytzinger_search touches
+fewer cache lines than a binary search on large vectors.
+*/
+vector *veytzinger(vector *v)
+{
+	vector *e = vnew_with_allocator(v->dtype, v->alloc);
+	if(!e)
+		return NULL;
+	if(!vresize(e, v->size)){
+		vfree(e);
+		return NULL;
+	}
+	veytzinger_fill(v->d, e->d, 0, 1, v->size, v->dtype);
+	return e;
+}
+
+/*
+Returns the index in the Eytzinger vector 'e' of the first
+member, in sorted order, that does not compare less than 'key',
+or the size of the vector if there is none.
+*/
+size_t veytzinger_search(vector *e, const void *key,
+			int (*cmp)(const void *, const void *))
+{
+	size_t n = e->size, dt = e->dtype;
+	const char *d = e->d;
+
+	//Descend the implicit tree, using 1-based indices
+	size_t k = 1;
+	while(k <= n){
+#ifdef __GNUC__
+		__builtin_prefetch(d + (16*k - 1)*dt);
+#endif
+		k = 2*k + (cmp(d + (k-1)*dt, key) < 0);
+	}
+
+	//Undo the right turns taken after the last left turn
+	while(k & 1)
+		k >>= 1;
+	k >>= 1;
+	return k ? k-1 : n;
+}
+
+
+
+//		SLICES
+
+/*
+Returns a slice of the 'n' members of the vector
+from index 'first', cut at the end of the vector.
+*/
+vslice vslice_of(vector *v, size_t first, size_t n)
+{
+	return vslice_step(v, first, n, 1);
+}
+
+/*
+Returns a slice of up to 'n' members of the vector
+from index 'first', taking one of every 'step' members.
+*/
+vslice vslice_step(vector *v, size_t first, size_t n, size_t step)
+{
+	if(step == 0)
+		step = 1;
+	vslice s;
+	s.dtype = v->dtype;
+	s.stride = step*v->dtype;
+	s.size = 0;
+	s.d = v->d;
+	if(first >= v->size)
+		return s;
+	size_t left = v->size - first;
+	size_t fit = left/step + (left % step != 0);
+	s.d = (char*)v->d + first*v->dtype;
+	s.size = n < fit ? n : fit;
+	return s;
+}
+
+/* Returns a contiguous slice of the array 'arr' */
+vslice vslice_array(void *arr, size_t n, size_t dtype)
+{
+	vslice s;
+	s.d = arr;
+	s.size = n;
+	s.dtype = dtype;
+	s.stride = dtype;
+	return s;
+}
+
+/* Returns the number of members of the slice */
+size_t vslsize(vslice s)
+{
+	return s.size;
+}
+
+/* Returns non-zero if the members of the slice are contiguous */
+int vslcontiguous(vslice s)
+{
+	return s.stride == s.dtype || s.size < 2;
+}
+
+/* Returns a pointer to member 'i' of the slice */
+void *vslat(vslice s, size_t i)
+{
+	if(i >= s.size)
+		return NULL;
+	return (char*)s.d + i*s.stride;
+}
+
+/*
+Allocates new vector with a copy of the members of the slice.
+Contiguous slices are copied with a single memcpy.
+*/
+vector *vslcopy(vslice s)
+{
+	vector *v = vnew(s.dtype);
+	if(!v)
+		return NULL;
+	if(!vresize(v, s.size)){
+		vfree(v);
+		return NULL;
+	}
+	if(vslcontiguous(s)){
+		memcpy(v->d, s.d, s.size*s.dtype);
+		return v;
+	}
+	char *d = v->d;
+	const char *src = s.d;
+	for(size_t i=0; i<s.size; i++)
+		memcpy(d + i*s.dtype, src + i*s.stride, s.dtype);
+	return v;
+}
+
+/*
+Returns the index of the first member of a sorted slice
+that does not compare less than 'key', or its size if there is none.
+*/
+size_t vsllower_bound(vslice s, const void *key,
+			int (*cmp)(const void *, const void *))
+{
+	size_t n = s.size, st = s.stride;
+	if(n == 0)
+		return 0;
+
+	//Halve the range without branching on the comparison
+	const char *base = s.d;
+	while(n > 1){
+		size_t half = n/2;
+		base = cmp(base + half*st, key) < 0 ? base + half*st : base;
+		n -= half;
+	}
+	return (base - (const char *)s.d)/st + (cmp(base, key) < 0);
+}
+
+/*
+Returns the index of the first member of a sorted slice
+that compares greater than 'key', or its size if there is none.
+*/
+size_t vslupper_bound(vslice s, const void *key,
+			int (*cmp)(const void *, const void *))
+{
+	size_t n = s.size, st = s.stride;
+	if(n == 0)
+		return 0;
+
+	const char *base = s.d;
+	while(n > 1){
+		size_t half = n/2;
+		base = cmp(base + half*st, key) <= 0 ? base + half*st : base;
+		n -= half;
+	}
+	return (base - (const char *)s.d)/st + (cmp(base, key) <= 0);
+}
+
+
+
+//		DOUBLE-ENDED QUEUE
+
+/*
+Allocates new double-ended queue of members
+of 'bytes' bytes and returns pointer to it
+*/
+vdeque *vdqnew(size_t bytes)
+{
+	vdeque *q = malloc(sizeof(vdeque));
+	if(!q)
+		return NULL;
+	q->d = NULL;
+	q->head = 0;
+	q->size = 0;
+	q->dtype = bytes;
+	q->capacity = 0;
+	return q;
+}
+
+/* Frees the queue */
+void vdqfree(vdeque *q)
+{
+	if(!q)
+		return;
+	free(q->d);
+	free(q);
+}
+
+/* Returns the number of members in the queue */
+size_t vdqsize(vdeque *q)
+{
+	return q->size;
+}
+
+/*
+Allocates memory for at least 'n' members.
+The capacity is kept as a power of two, so that
+indices wrap around with a mask.
+*/
+vdeque *vdqreserve(vdeque *q, size_t n)
+{
+	if(n <= q->capacity)
+		return q;
+	size_t cap = q->capacity ? q->capacity : VECTOR_MIN_CAPACITY;
+	while(cap < n){
+		if(cap > SIZE_MAX/2)
+			return NULL;
+		cap *= 2;
+	}
+	if(q->dtype && cap > SIZE_MAX / q->dtype)
+		return NULL;
+	char *d = realloc(q->d, cap*q->dtype);
+	if(!d)
+		return NULL;
+
+	//Move the members that wrapped around past the old end
+	size_t dt = q->dtype;
+	if(q->head + q->size > q->capacity){
+		size_t wrapped = q->head + q->size - q->capacity;
+		memcpy(d + q->capacity*dt, d, wrapped*dt);
+	}
+	q->d = d;
+	q->capacity = cap;
+	return q;
+}
+
+/*
+Returns a pointer to the member at index 'i',
+counting from the front of the queue
+*/
+void *vdqat(vdeque *q, size_t i)
+{
+	if(i >= q->size)
+		return NULL;
+	return (char*)q->d + ((q->head + i) & (q->capacity-1))*q->dtype;
+}
+
+/* Returns a pointer to the first member, or NULL if empty */
+void *vdqfront(vdeque *q)
+{
+	return vdqat(q, 0);
+}
+
+/* Returns a pointer to the last member, or NULL if empty */
+void *vdqback(vdeque *q)
+{
+	if(q->size == 0)
+		return NULL;
+	return vdqat(q, q->size-1);
+}
+
+/* Appends a new member at the back of the queue */
+vdeque *vdqpush_back(vdeque *q, const void *new)
+{
+	if(q->size == q->capacity && !vdqreserve(q, q->size+1))
+		return NULL;
+	size_t i = (q->head + q->size) & (q->capacity-1);
+	memcpy((char*)q->d + i*q->dtype, new, q->dtype);
+	q->size++;
+	return q;
+}
+
+/* Inserts a new member at the front of the queue */
+vdeque *vdqpush_front(vdeque *q, const void *new)
+{
+	if(q->size == q->capacity && !vdqreserve(q, q->size+1))
+		return NULL;
+	q->head = (q->head - 1) & (q->capacity-1);
+	memcpy((char*)q->d + q->head*q->dtype, new, q->dtype);
+	q->size++;
+	return q;
+}
+
+/*
+Removes the last member of the queue.
+If 'dest' is not NULL, the member is copied into it.
+*/
+vdeque *vdqpop_back(vdeque *q, void *dest)
+{
+	if(q->size == 0)
+		return NULL;
+	if(dest)
+		memcpy(dest, vdqback(q), q->dtype);
+	q->size--;
+	return q;
+}
+
+/*
+Removes the first member of the queue.
+If 'dest' is not NULL, the member is copied into it.
+*/
+vdeque *vdqpop_front(vdeque *q, void *dest)
+{
+	if(q->size == 0)
+		return NULL;
+	if(dest)
+		memcpy(dest, vdqfront(q), q->dtype);
+	q->head = (q->head + 1) & (q->capacity-1);
+	q->size--;
+	return q;
+}
+
+/*
+Removes the first 'n' members of the queue,
+e.g. after processing them through vdqspan.
+*/
+vdeque *vdqdrop_front(vdeque *q, size_t n)
+{
+	if(n > q->size)
+		return NULL;
+	if(n == 0)
+		return q;
+	q->head = (q->head + n) & (q->capacity-1);
+	q->size -= n;
+	return q;
+}
+
+/*
+Returns a pointer to the first member, and stores in 'n'
+the number of members that follow it contiguously in memory,
+before the queue wraps around.
+*/
+void *vdqspan(vdeque *q, size_t *n)
+{
+	if(q->size == 0){
+		*n = 0;
+		return NULL;
+	}
+	size_t run = q->capacity - q->head;
+	*n = run < q->size ? run : q->size;
+	return (char*)q->d + q->head*q->dtype;
+}
+
+/*
+Rearranges the queue so that all of its members are
+contiguous in memory, and returns a pointer to the first one.
+*/
+void *vdqlinearize(vdeque *q)
+{
+	if(q->size == 0)
+		return NULL;
+	size_t dt = q->dtype;
+	if(q->head + q->size <= q->capacity)
+		return (char*)q->d + q->head*dt;
+
+	//Copy both parts in order into a new buffer
+	size_t first = q->capacity - q->head;
+	char *d = malloc(q->capacity*dt);
+	if(!d)
+		return NULL;
+	memcpy(d, (char*)q->d + q->head*dt, first*dt);
+	memcpy(d + first*dt, q->d, (q->size - first)*dt);
+	free(q->d);
+	q->d = d;
+	q->head = 0;
+	return d;
+}
+
+
+
+//		SEGMENTED VECTOR
+
+/*
+Allocates new segmented vector of members of 'bytes' bytes,
+stored in chunks of 'chunk' members, and returns pointer to it.
+The chunk size is rounded up to a power of two.
+If 'chunk' is zero, chunks of about SVECTOR_CHUNK_BYTES are used.
+*/
+svector *svnew(size_t bytes, size_t chunk)
+{
+	if(chunk == 0)
+		chunk = bytes && bytes < SVECTOR_CHUNK_BYTES ? SVECTOR_CHUNK_BYTES / bytes : 1;
+	size_t shift = 0;
+	while(((size_t)1 << shift) < chunk){
+		if(shift == sizeof(size_t)*8 - 2)
+			return NULL;
+		shift++;
+	}
+
+	svector *s = malloc(sizeof(svector));
+	if(!s)
+		return NULL;
+	s->chunks = NULL;
+	s->nchunks = 0;
+	s->tablecap = 0;
+	s->size = 0;
+	s->dtype = bytes;
+	s->shift = shift;
+	return s;
+}
+
+/* Frees the segmented vector */
+void svfree(svector *s)
+{
+	if(!s)
+		return;
+	for(size_t k=0; k<s->nchunks; k++)
+		free(s->chunks[k]);
+	free(s->chunks);
+	free(s);
+}
+
+/* Returns the size of the segmented vector */
+size_t svsize(svector *s)
+{
+	return s->size;
+}
+
+/* Returns the number of members per chunk */
+size_t svchunk_size(svector *s)
+{
+	return (size_t)1 << s->shift;
+}
+
+/*
+Allocates chunks to hold at least 'n' members.
+Existing members are never moved.
+*/
+svector *svreserve(svector *s, size_t n)
+{
+	size_t per = svchunk_size(s);
+	size_t need = n/per + (n % per != 0);
+	if(need <= s->nchunks)
+		return s;
+	if(s->dtype && per > SIZE_MAX / s->dtype)
+		return NULL;
+
+	//Only the table of chunk pointers is reallocated
+	if(need > s->tablecap){
+		size_t cap = s->tablecap ? s->tablecap : VECTOR_MIN_CAPACITY;
+		while(cap < need)
+			cap *= VECTOR_GROWTH;
+		void **t = realloc(s->chunks, cap*sizeof(void*));
+		if(!t)
+			return NULL;
+		s->chunks = t;
+		s->tablecap = cap;
+	}
+	while(s->nchunks < need){
+		void *c = malloc(per*s->dtype);
+		if(!c)
+			return NULL;
+		s->chunks[s->nchunks++] = c;
+	}
+	return s;
+}
+
+/*
+Returns a pointer to a member of the segmented vector.
+Pointers stay valid until the member is removed.
+*/
+void *svat(svector *s, size_t i)
+{
+	if(i >= s->size)
+		return NULL;
+	size_t mask = ((size_t)1 << s->shift) - 1;
+	return (char*)s->chunks[i >> s->shift] + (i & mask)*s->dtype;
+}
+
+/* Changes the value of a member */
+svector *svset(svector *s, size_t i, const void *src)
+{
+	void *dest = svat(s, i);
+	if(!dest)
+		return NULL;
+	memcpy(dest, src, s->dtype);
+	return s;
+}
+
+/*
+Appends a new uninitialised member at the end of the
+segmented vector and returns a pointer to it.
+*/
+void *svemplace(svector *s)
+{
+	if(s->size == SIZE_MAX || !svreserve(s, s->size+1))
+		return NULL;
+	s->size++;
+	return svat(s, s->size-1);
+}
+
+/* Appends a new member at the end of the segmented vector */
+svector *svpush(svector *s, const void *new)
+{
+	void *dest = svemplace(s);
+	if(!dest)
+		return NULL;
+	memcpy(dest, new, s->dtype);
+	return s;
+}
+
+/*
+Removes the last member of the segmented vector.
+If 'dest' is not NULL, the member is copied into it.
+Chunks are kept for later use.
+*/
+svector *svpop(svector *s, void *dest)
+{
+	if(s->size == 0)
+		return NULL;
+	if(dest)
+		memcpy(dest, svat(s, s->size-1), s->dtype);
+	s->size--;
+	return s;
+}
+
+/* Returns the number of chunks that hold members */
+size_t svnchunks(svector *s)
+{
+	return (s->size >> s->shift) + ((s->size & (svchunk_size(s)-1)) != 0);
+}
+
+/*
+Returns a pointer to the first member of chunk 'k',
+and stores in 'n' the number of members it holds,
+so that the vector can be processed chunk by chunk.
+Returns NULL if the chunk holds no members.
+*/
+void *svchunk(svector *s, size_t k, size_t *n)
+{
+	size_t per = svchunk_size(s);
+	if(k >= svnchunks(s)){
+		*n = 0;
+		return NULL;
+	}
+	size_t left = s->size - k*per;
+	*n = left < per ? left : per;
+	return s->chunks[k];
+}
+
+
+
+//		STRUCT OF ARRAYS
+
+/*
+Allocates new struct of arrays with 'ncols' columns,
+whose members are of 'dtypes[c]' bytes, and returns pointer to it.
+*/
+vsoa *soanew(size_t ncols, const size_t *dtypes)
+{
+	vsoa *s = malloc(sizeof(vsoa));
+	if(!s)
+		return NULL;
+	s->cols = calloc(ncols ? ncols : 1, sizeof(void*));
+	s->dtypes = malloc((ncols ? ncols : 1)*sizeof(size_t));
+	if(!s->cols || !s->dtypes){
+		free(s->cols);
+		free(s->dtypes);
+		free(s);
+		return NULL;
+	}
+	memcpy(s->dtypes, dtypes, ncols*sizeof(size_t));
+	s->ncols = ncols;
+	s->size = 0;
+	s->capacity = 0;
+	return s;
+}
+
+/* Frees the struct of arrays */
+void soafree(vsoa *s)
+{
+	if(!s)
+		return;
+	for(size_t c=0; c<s->ncols; c++)
+		free(s->cols[c]);
+	free(s->cols);
+	free(s->dtypes);
+	free(s);
+}
+
+/* Returns the number of records */
+size_t soasize(vsoa *s)
+{
+	return s->size;
+}
+
+/* Returns the number of columns */
+size_t soancols(vsoa *s)
+{
+	return s->ncols;
+}
+
+/* Returns the number of records that fit without reallocating */
+size_t soacapacity(vsoa *s)
+{
+	return s->capacity;
+}
+
+/*
+Grows every column to hold at least 'n' records.
+If a column fails to grow, the capacity is left unchanged,
+as the columns that did grow still hold the old records.
+*/
+vsoa *soareserve(vsoa *s, size_t n)
+{
+	if(n <= s->capacity)
+		return s;
+	for(size_t c=0; c<s->ncols; c++)
+		if(s->dtypes[c] && n > SIZE_MAX / s->dtypes[c])
+			return NULL;
+	for(size_t c=0; c<s->ncols; c++){
+		size_t bytes = n*s->dtypes[c];
+		void *d = realloc(s->cols[c], bytes ? bytes : 1);
+		if(!d)
+			return NULL;
+		s->cols[c] = d;
+	}
+	s->capacity = n;
+	return s;
+}
+
+/* Grows the columns geometrically to hold at least 'n' records */
+static vsoa *soagrow(vsoa *s, size_t n)
+{
+	if(n <= s->capacity)
+		return s;
+	size_t cap = s->capacity ? s->capacity : VECTOR_MIN_CAPACITY;
+	while(cap < n){
+		if(cap > SIZE_MAX / VECTOR_GROWTH){
+			cap = n;
+			break;
+		}
+		cap *= VECTOR_GROWTH;
+	}
+	return soareserve(s, cap);
+}
+
+/* Returns a pointer to the first member of column 'c' */
+void *soacol(vsoa *s, size_t c)
+{
+	if(c >= s->ncols)
+		return NULL;
+	return s->cols[c];
+}
+
+/* Returns a pointer to the member of column 'c' of record 'i' */
+void *soaat(vsoa *s, size_t c, size_t i)
+{
+	if(c >= s->ncols || i >= s->size)
+		return NULL;
+	return (char*)s->cols[c] + i*s->dtypes[c];
+}
+
+/* Copies the fields of record 'i' from the pointers 'fields' */
+vsoa *soaset(vsoa *s, size_t i, const void *const *fields)
+{
+	if(i >= s->size)
+		return NULL;
+	for(size_t c=0; c<s->ncols; c++)
+		if(fields[c])
+			memcpy((char*)s->cols[c] + i*s->dtypes[c], fields[c], s->dtypes[c]);
+	return s;
+}
+
+/* Copies the fields of record 'i' into the pointers 'dest' */
+vsoa *soaget(vsoa *s, size_t i, void *const *dest)
+{
+	if(i >= s->size)
+		return NULL;
+	for(size_t c=0; c<s->ncols; c++)
+		if(dest[c])
+			memcpy(dest[c], (char*)s->cols[c] + i*s->dtypes[c], s->dtypes[c]);
+	return s;
+}
+
+/*
+Inserts a record at index 'j', with its fields copied from the
+pointers 'fields'. Missing fields are set to zero.
+*/
+vsoa *soainsert(vsoa *s, size_t j, const void *const *fields)
+{
+	if(j > s->size || s->size == SIZE_MAX || !soagrow(s, s->size+1))
+		return NULL;
+	for(size_t c=0; c<s->ncols; c++){
+		size_t dt = s->dtypes[c];
+		char *d = (char*)s->cols[c] + j*dt;
+		memmove(d + dt, d, (s->size - j)*dt);
+		if(fields && fields[c])
+			memcpy(d, fields[c], dt);
+		else
+			memset(d, 0, dt);
+	}
+	s->size++;
+	return s;
+}
+
+/* Appends a record at the end */
+vsoa *soapush(vsoa *s, const void *const *fields)
+{
+	return soainsert(s, s->size, fields);
+}
+
+/* Deletes the record at index 'j', shifting the following ones */
+vsoa *soadelete(vsoa *s, size_t j)
+{
+	if(j >= s->size)
+		return NULL;
+	for(size_t c=0; c<s->ncols; c++){
+		size_t dt = s->dtypes[c];
+		char *d = (char*)s->cols[c] + j*dt;
+		memmove(d, d + dt, (s->size - j - 1)*dt);
+	}
+	s->size--;
+	return s;
+}
+
+/*
+Deletes the record at index 'j' by moving the last record
+into its place.
+*/
+vsoa *soaswap_remove(vsoa *s, size_t j)
+{
+	if(j >= s->size)
+		return NULL;
+	s->size--;
+	if(j != s->size)
+		for(size_t c=0; c<s->ncols; c++){
+			size_t dt = s->dtypes[c];
+			char *d = s->cols[c];
+			memcpy(d + j*dt, d + s->size*dt, dt);
+		}
+	return s;
+}
+
+/*
+Changes the number of records to 'n'.
+New records are set to zero.
+*/
+vsoa *soaresize(vsoa *s, size_t n)
+{
+	if(!soareserve(s, n))
+		return NULL;
+	if(n > s->size)
+		for(size_t c=0; c<s->ncols; c++){
+			size_t dt = s->dtypes[c];
+			memset((char*)s->cols[c] + s->size*dt, 0, (n - s->size)*dt);
+		}
+	s->size = n;
+	return s;
+}
+
+
+//		FILE-BACKED VECTORS
+
+/*
+Header at the start of vector files.
+The members follow it, at offset VECTOR_FILE_HEADER.
+*/
+typedef struct vfileheaderStruct
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t endian;
+	uint64_t dtype;
+	uint64_t size;
+	uint64_t checksum;
+	uint64_t flags;
+} vfileheader;
+
+#define VFILE_MAGIC "CVECTOR"
+#define VFILE_VERSION 1
+#define VFILE_ENDIAN 0x01020304u
+
+/* Header flag: the checksum matches the data */
+#define VFILE_CHECKSUM 0x1
+
+/* Fills in a file header for the vector 'v' */
+static void vfile_header(vfileheader *h, vector *v)
+{
+	memset(h, 0, sizeof(vfileheader));
+	memcpy(h->magic, VFILE_MAGIC, sizeof(VFILE_MAGIC));
+	h->version = VFILE_VERSION;
+	h->endian = VFILE_ENDIAN;
+	h->dtype = v->dtype;
+	h->size = v->size;
+}
+
+/*
+Checks that a file header was written by this library
+on a machine of the same byte order
+*/
+static int vfile_header_ok(const vfileheader *h)
+{
+	return memcmp(h->magic, VFILE_MAGIC, sizeof(VFILE_MAGIC)) == 0
+		&& h->version == VFILE_VERSION
+		&& h->endian == VFILE_ENDIAN
+		&& h->dtype != 0;
+}
+
+/*
+Returns a checksum of 'n' bytes of data.
+It sums 64-bit words along with the running sum,
+so that it runs at memory speed and is sensitive to order.
+*/
+static uint64_t vchecksum(const void *data, size_t n)
+{
+	const unsigned char *p = data;
+	uint64_t a = 1, b = 0;
+	size_t i = 0;
+	for(; i+8 <= n; i+=8){
+		uint64_t w;
+		memcpy(&w, p+i, 8);
+		a += w;
+		b += a;
+	}
+	for(; i<n; i++){
+		a += p[i];
+		b += a;
+	}
+	return a ^ (b << 1 | b >> 63) ^ (uint64_t)n;
+}
+
+
+#ifdef VECTOR_MMAP
+
+/*
+Mapping of a vector file. 'len' is the length of the file,
+and 'maplen' the number of bytes mapped from 'base', which
+may be longer when a shrink leaves the last page mapped.
+*/
+struct vmapStruct
+{
+	int fd;
+	char *base;
+	size_t len;
+	size_t maplen;
+};
+
+/*
+Changes the length of the file and of its mapping
+to hold 'cap' members
+*/
+static vector *vmap_resize(vector *v, size_t cap)
+{
+	struct vmapStruct *m = v->map;
+
+	//Views move their data to memory instead of changing the file
+	if(v->flags & VFLAG_VIEW){
+		if(v->dtype && cap > SIZE_MAX / v->dtype)
+			return NULL;
+		void *d = NULL;
+		if(cap > 0 && !(d = malloc(cap*v->dtype)))
+			return NULL;
+		size_t keep = v->size < cap ? v->size : cap;
+		if(keep > 0)
+			memcpy(d, v->d, keep*v->dtype);
+		munmap(m->base, m->maplen);
+		free(m);
+		v->map = NULL;
+		v->flags &= ~(VFLAG_MAPPED|VFLAG_VIEW);
+		v->d = d;
+		v->capacity = cap;
+		return v;
+	}
+
+	if(v->dtype && cap > (SIZE_MAX - VECTOR_FILE_HEADER) / v->dtype)
+		return NULL;
+	size_t len = VECTOR_FILE_HEADER + cap*v->dtype;
+	if(len == m->len)
+		return v;
+
+	if(ftruncate(m->fd, (off_t)len) != 0)
+		return NULL;
+
+	/*
+	Shrinking: unmap the whole pages past the new end of the file,
+	as touching them raises SIGBUS. The page holding the new end
+	stays mapped, and 'maplen' keeps track of it.
+	*/
+	if(len < m->len){
+		size_t page = (size_t) sysconf(_SC_PAGESIZE);
+		size_t keep = (len + page - 1) / page * page;
+		if(keep < m->maplen && munmap(m->base + keep, m->maplen - keep) == 0)
+			m->maplen = keep;
+	}
+
+	if(len > m->maplen){
+#ifdef __linux__
+		void *base = mremap(m->base, m->maplen, len, MREMAP_MAYMOVE);
+		if(base == MAP_FAILED)
+			return NULL;
+#else
+		void *base = mmap(NULL, len, PROT_READ|PROT_WRITE, MAP_SHARED, m->fd, 0);
+		if(base == MAP_FAILED)
+			return NULL;
+		munmap(m->base, m->maplen);
+#endif
+		m->base = base;
+		m->maplen = len;
+	}
+	m->len = len;
+	v->d = m->base + VECTOR_FILE_HEADER;
+	v->capacity = cap;
+	return v;
+}
+
+/* Writes the size into the file header and flushes the mapping */
+static vector *vmap_sync(vector *v)
+{
+	struct vmapStruct *m = v->map;
+	if(v->flags & VFLAG_VIEW)
+		return v;
+	vfileheader *h = (vfileheader *) m->base;
+	h->size = v->size;
+	if(msync(m->base, m->len, MS_SYNC) != 0)
+		return NULL;
+	return v;
+}
+
+/* Saves the size, unmaps and closes the file */
+static void vmap_close(vector *v)
+{
+	struct vmapStruct *m = v->map;
+	if(!(v->flags & VFLAG_VIEW)){
+		((vfileheader *) m->base)->size = v->size;
+		close(m->fd);
+	}
+	munmap(m->base, m->maplen);
+	free(m);
+	v->map = NULL;
+}
+
+/*
+Maps the file 'fd' of 'len' bytes into a new vector.
+The file descriptor is closed on fail.
+*/
+static vector *vmap_new(int fd, size_t len)
+{
+	vector *v = vnew(0);
+	struct vmapStruct *m = malloc(sizeof(struct vmapStruct));
+	void *base = mmap(NULL, len, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+	if(!v || !m || base == MAP_FAILED){
+		if(base != MAP_FAILED)
+			munmap(base, len);
+		free(m);
+		free(v);
+		close(fd);
+		return NULL;
+	}
+	m->fd = fd;
+	m->base = base;
+	m->len = len;
+	m->maplen = len;
+	v->map = m;
+	v->flags |= VFLAG_MAPPED;
+	v->d = m->base + VECTOR_FILE_HEADER;
+	return v;
+}
+
+/*
+Creates a new vector of members of 'bytes' bytes
+whose data is stored in the file at 'path',
+which is created or overwritten.
+*/
+vector *vnew_mapped(const char *path, size_t bytes)
+{
+	if(bytes == 0)
+		return NULL;
+	int fd = open(path, O_RDWR|O_CREAT|O_TRUNC, 0644);
+	if(fd < 0)
+		return NULL;
+	if(ftruncate(fd, VECTOR_FILE_HEADER) != 0){
+		close(fd);
+		return NULL;
+	}
+	vector *v = vmap_new(fd, VECTOR_FILE_HEADER);
+	if(!v)
+		return NULL;
+	v->dtype = bytes;
+	v->capacity = 0;
+	vfile_header((vfileheader *) v->map->base, v);
+	return v;
+}
+
+/*
+Opens a vector stored in the file at 'path'
+by vnew_mapped or vsave, without reading it into memory.
+Changes to the vector are written back to the file.
+*/
+vector *vopen_mapped(const char *path)
+{
+	int fd = open(path, O_RDWR);
+	if(fd < 0)
+		return NULL;
+	struct stat st;
+	if(fstat(fd, &st) != 0 || (size_t)st.st_size < VECTOR_FILE_HEADER){
+		close(fd);
+		return NULL;
+	}
+	vector *v = vmap_new(fd, (size_t)st.st_size);
+	if(!v)
+		return NULL;
+
+	//Invalid files are closed without writing to them
+	struct vmapStruct *m = v->map;
+	const vfileheader *h = (const vfileheader *) m->base;
+	size_t cap = h->dtype ? (m->len - VECTOR_FILE_HEADER) / h->dtype : 0;
+	if(!vfile_header_ok(h) || h->size > cap){
+		munmap(m->base, m->maplen);
+		close(m->fd);
+		free(m);
+		free(v);
+		return NULL;
+	}
+	v->dtype = h->dtype;
+	v->size = h->size;
+	v->capacity = cap;
+
+	//The data may change from now on
+	((vfileheader *) m->base)->flags &= ~(uint64_t)VFILE_CHECKSUM;
+	return v;
+}
+
+/*
+Opens a vector stored in the file at 'path' by vsave
+or vnew_mapped, mapping it into memory instead of reading it.
+The checksum is not verified, and the file is never modified:
+changed members are copied in memory as needed,
+and the whole vector is read into memory once it grows.
+*/
+vector *vload_view(const char *path)
+{
+	int fd = open(path, O_RDONLY);
+	if(fd < 0)
+		return NULL;
+	struct stat st;
+	if(fstat(fd, &st) != 0 || (size_t)st.st_size < VECTOR_FILE_HEADER){
+		close(fd);
+		return NULL;
+	}
+	size_t len = (size_t)st.st_size;
+	void *base = mmap(NULL, len, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(base == MAP_FAILED)
+		return NULL;
+
+	const vfileheader *h = base;
+	size_t cap = h->dtype ? (len - VECTOR_FILE_HEADER) / h->dtype : 0;
+	vector *v = vnew(h->dtype);
+	struct vmapStruct *m = malloc(sizeof(struct vmapStruct));
+	if(!vfile_header_ok(h) || h->size > cap || !v || !m){
+		munmap(base, len);
+		free(m);
+		free(v);
+		return NULL;
+	}
+	m->fd = -1;
+	m->base = base;
+	m->len = len;
+	m->maplen = len;
+	v->map = m;
+	v->flags |= VFLAG_MAPPED|VFLAG_VIEW;
+	v->d = m->base + VECTOR_FILE_HEADER;
+	v->size = h->size;
+
+	//Growing must copy, as the mapping cannot extend past the file
+	v->capacity = h->size;
+	return v;
+}
+
+#else
+
+static vector *vmap_resize(vector *v, size_t cap)
+{
+	(void) v; (void) cap;
+	return NULL;
+}
+
+static vector *vmap_sync(vector *v)
+{
+	return v;
+}
+
+static void vmap_close(vector *v)
+{
+	(void) v;
+}
+
+vector *vnew_mapped(const char *path, size_t bytes)
+{
+	(void) path; (void) bytes;
+	return NULL;
+}
+
+vector *vopen_mapped(const char *path)
+{
+	(void) path;
+	return NULL;
+}
+
+vector *vload_view(const char *path)
+{
+	return vload(path);
+}
+
+#endif
+
+/*
+Writes the changes to a file-backed vector to its file.
+Other vectors are left untouched.
+*/
+vector *vsync(vector *v)
+{
+	if(!(v->flags & VFLAG_MAPPED))
+		return v;
+	return vmap_sync(v);
+}
+
+/*
+Saves the vector into the file at 'path', as a header
+followed by the raw members, which can be read back with
+vload, vload_view or vopen_mapped.
+*/
+vector *vsave(vector *v, const char *path)
+{
+	vfileheader h;
+	vfile_header(&h, v);
+	size_t bytes = v->size*v->dtype;
+	h.checksum = vchecksum(v->d, bytes);
+	h.flags = VFILE_CHECKSUM;
+
+	//Pad the header up to where the members start
+	char head[VECTOR_FILE_HEADER] = {0};
+	memcpy(head, &h, sizeof(vfileheader));
+
+	FILE *f = fopen(path, "wb");
+	if(!f)
+		return NULL;
+	int ok = fwrite(head, 1, VECTOR_FILE_HEADER, f) == VECTOR_FILE_HEADER;
+	if(ok && bytes > 0)
+		ok = fwrite(v->d, 1, bytes, f) == bytes;
+	if(fclose(f) != 0 || !ok)
+		return NULL;
+	return v;
+}
+
+/*
+Loads a vector saved with vsave into a new vector.
+Returns NULL if the file cannot be read, was written on
+a machine of different byte order, or fails its checksum.
+*/
+vector *vload(const char *path)
+{
+	FILE *f = fopen(path, "rb");
+	if(!f)
+		return NULL;
+
+	char head[VECTOR_FILE_HEADER];
+	vfileheader h;
+	if(fread(head, 1, VECTOR_FILE_HEADER, f) != VECTOR_FILE_HEADER){
+		fclose(f);
+		return NULL;
+	}
+	memcpy(&h, head, sizeof(vfileheader));
+	if(!vfile_header_ok(&h) || h.size > SIZE_MAX / h.dtype){
+		fclose(f);
+		return NULL;
+	}
+
+	vector *v = vnew(h.dtype);
+	if(!v || !vresize(v, h.size)){
+		vfree(v);
+		fclose(f);
+		return NULL;
+	}
+	size_t bytes = v->size*v->dtype;
+	int ok = bytes == 0 || fread(v->d, 1, bytes, f) == bytes;
+	fclose(f);
+	if(ok && (h.flags & VFILE_CHECKSUM))
+		ok = vchecksum(v->d, bytes) == h.checksum;
+	if(!ok){
+		vfree(v);
+		return NULL;
+	}
+	return v;
+}
+
+
+
+//		CONCURRENT APPEND
+
+#ifdef VECTOR_ATOMICS
+
+/*
+Shared state of a vector in concurrent append mode.
+'ready' holds one flag per slot of 'data', set once the
+member in that slot has been written.
+'written' counts the members written so far, in any order.
+*/
+struct vconcStruct
+{
+	atomic_size_t claimed;
+	atomic_size_t written;
+	atomic_size_t capacity;
+	_Atomic(char *) data;
+	_Atomic(atomic_uchar *) ready;
+	atomic_int failed;
+
+	//Buffers replaced by growth, freed at the end
+	void **retired;
+	size_t *retired_bytes;
+	size_t nretired;
+};
+
+/* Lets other threads run while waiting */
+static inline void vconc_wait(void)
+{
+#ifdef VECTOR_MMAP
+	sched_yield();
+#endif
+}
+
+/* Allocates 'n' ready flags, with the first 'set' of them set */
+static atomic_uchar *vconc_flags(vector *v, size_t n, size_t set)
+{
+	atomic_uchar *r = vraw_alloc(v->alloc, n*sizeof(atomic_uchar));
+	if(!r)
+		return NULL;
+	for(size_t i=0; i<n; i++)
+		atomic_init(&r[i], i < set);
+	return r;
+}
+
+/* Adds a buffer to the list of those freed at the end */
+static int vconc_retire(struct vconcStruct *c, void *p, size_t bytes)
+{
+	void **r = realloc(c->retired, (c->nretired+1)*sizeof(void*));
+	if(!r)
+		return 0;
+	c->retired = r;
+	size_t *rb = realloc(c->retired_bytes, (c->nretired+1)*sizeof(size_t));
+	if(!rb)
+		return 0;
+	c->retired_bytes = rb;
+	c->retired[c->nretired] = p;
+	c->retired_bytes[c->nretired] = bytes;
+	c->nretired++;
+	return 1;
+}
+
+/*
+Makes the vector grow from 'cap' members.
+Only the thread that claims index 'cap' calls this. It waits
+for the members already being written to the slots before 'cap',
+which no other thread can claim, and none past it can be written
+until the capacity grows.
+*/
+static void vconc_grow(vector *v, size_t cap)
+{
+	struct vconcStruct *c = v->conc;
+	while(atomic_load_explicit(&c->written, memory_order_acquire) != cap)
+		vconc_wait();
+
+	size_t newcap = cap > SIZE_MAX / VECTOR_GROWTH ? 0 : cap*VECTOR_GROWTH;
+	char *old = atomic_load_explicit(&c->data, memory_order_relaxed);
+	atomic_uchar *oldready = atomic_load_explicit(&c->ready, memory_order_relaxed);
+	char *d = NULL;
+	atomic_uchar *r = NULL;
+	if(newcap && v->dtype <= SIZE_MAX / newcap){
+		d = vraw_alloc(v->alloc, newcap*v->dtype);
+		r = d ? vconc_flags(v, newcap, cap) : NULL;
+	}
+
+	//Readers may still hold the old buffers, so they are kept until the end
+	if(!r || !vconc_retire(c, old, cap*v->dtype)){
+		vraw_free(v->alloc, d, newcap*v->dtype);
+		vraw_free(v->alloc, r, newcap*sizeof(atomic_uchar));
+		atomic_store_explicit(&c->failed, 1, memory_order_release);
+		return;
+	}
+	if(!vconc_retire(c, oldready, cap*sizeof(atomic_uchar))){
+		c->nretired--;
+		vraw_free(v->alloc, d, newcap*v->dtype);
+		vraw_free(v->alloc, r, newcap*sizeof(atomic_uchar));
+		atomic_store_explicit(&c->failed, 1, memory_order_release);
+		return;
+	}
+	memcpy(d, old, cap*v->dtype);
+	atomic_store_explicit(&c->data, d, memory_order_release);
+	atomic_store_explicit(&c->ready, r, memory_order_release);
+	atomic_store_explicit(&c->capacity, newcap, memory_order_release);
+}
+
+/*
+Switches the vector to concurrent append mode, reserving
+memory for at least 'n' members. Until vconcurrent_end is called,
+only vpush_concurrent, vsize_concurrent and vat_concurrent
+may be used on the vector, from any number of threads.
+File-backed vectors, aligned vectors and vectors using
+an inline buffer cannot be switched.
+*/
+vector *vconcurrent_begin(vector *v, size_t n)
+{
+	if(v->conc || (v->flags & (VFLAG_INLINE|VFLAG_MAPPED|VFLAG_ALIGNED)))
+		return NULL;
+	if(n < VECTOR_MIN_CAPACITY)
+		n = VECTOR_MIN_CAPACITY;
+	if(!vreserve(v, n))
+		return NULL;
+	struct vconcStruct *c = malloc(sizeof(struct vconcStruct));
+	if(!c)
+		return NULL;
+	atomic_uchar *r = vconc_flags(v, v->capacity, v->size);
+	if(!r){
+		free(c);
+		return NULL;
+	}
+	atomic_init(&c->claimed, v->size);
+	atomic_init(&c->written, v->size);
+	atomic_init(&c->capacity, v->capacity);
+	atomic_init(&c->data, (char *) v->d);
+	atomic_init(&c->ready, r);
+	atomic_init(&c->failed, 0);
+	c->retired = NULL;
+	c->retired_bytes = NULL;
+	c->nretired = 0;
+	v->conc = c;
+	return v;
+}
+
+/*
+Appends a new member to a vector in concurrent append mode.
+Slots are claimed with an atomic counter, and each member is
+marked as ready on its own, so threads never wait for one another
+to write their members. They only wait while the thread that
+outgrows the capacity moves the members to a larger buffer.
+*/
+vector *vpush_concurrent(vector *v, const void *new)
+{
+	struct vconcStruct *c = v->conc;
+	size_t i = atomic_fetch_add_explicit(&c->claimed, 1, memory_order_relaxed);
+
+	//Wait for the vector to have room for the claimed slot
+	for(;;){
+		size_t cap = atomic_load_explicit(&c->capacity, memory_order_acquire);
+		if(i < cap)
+			break;
+		if(atomic_load_explicit(&c->failed, memory_order_acquire))
+			return NULL;
+		if(i == cap)
+			vconc_grow(v, cap);
+		else
+			vconc_wait();
+	}
+
+	//Growth waits for this member, so the buffers cannot change here
+	char *d = atomic_load_explicit(&c->data, memory_order_acquire);
+	atomic_uchar *r = atomic_load_explicit(&c->ready, memory_order_acquire);
+	memcpy(d + i*v->dtype, new, v->dtype);
+	atomic_store_explicit(&r[i], 1, memory_order_release);
+	atomic_fetch_add_explicit(&c->written, 1, memory_order_release);
+	return v;
+}
+
+/*
+Returns the number of slots claimed so far in a vector
+in concurrent append mode. Members are written in any order,
+so some of them may not be ready yet.
+*/
+size_t vsize_concurrent(vector *v)
+{
+	struct vconcStruct *c = v->conc;
+	size_t n = atomic_load_explicit(&c->claimed, memory_order_acquire);
+	size_t cap = atomic_load_explicit(&c->capacity, memory_order_acquire);
+	return n < cap ? n : cap;
+}
+
+/*
+Returns a pointer to a member of a vector in concurrent append
+mode, or NULL if it has not been written yet. It stays valid
+until vconcurrent_end is called.
+*/
+void *vat_concurrent(vector *v, size_t i)
+{
+	struct vconcStruct *c = v->conc;
+
+	/*
+	Growth replaces the data, then the flags, then the capacity,
+	so loading them in the opposite order never finds flags
+	shorter than the capacity, or data older than the flags.
+	*/
+	if(i >= atomic_load_explicit(&c->capacity, memory_order_acquire))
+		return NULL;
+	atomic_uchar *r = atomic_load_explicit(&c->ready, memory_order_acquire);
+	char *d = atomic_load_explicit(&c->data, memory_order_acquire);
+	if(!atomic_load_explicit(&r[i], memory_order_acquire))
+		return NULL;
+	return d + i*v->dtype;
+}
+
+/*
+Switches the vector back to normal mode, once every thread
+has finished with it. Buffers left over from growth are freed.
+*/
+vector *vconcurrent_end(vector *v)
+{
+	struct vconcStruct *c = v->conc;
+	if(!c)
+		return NULL;
+	v->d = atomic_load(&c->data);
+	v->capacity = atomic_load(&c->capacity);
+	v->size = atomic_load(&c->written);
+	vraw_free(v->alloc, atomic_load(&c->ready), v->capacity*sizeof(atomic_uchar));
+	for(size_t k=0; k<c->nretired; k++)
+		vraw_free(v->alloc, c->retired[k], c->retired_bytes[k]);
+	free(c->retired);
+	free(c->retired_bytes);
+	free(c);
+	v->conc = NULL;
+	return v;
+}
+
+#else
+
+vector *vconcurrent_begin(vector *v, size_t n)
+{
+	(void) v; (void) n;
+	return NULL;
+}
+
+vector *vpush_concurrent(vector *v, const void *new)
+{
+	(void) v; (void) new;
+	return NULL;
+}
+
+size_t vsize_concurrent(vector *v)
+{
+	return v->size;
+}
+
+void *vat_concurrent(vector *v, size_t i)
+{
+	return vat(v, i);
+}
+
+vector *vconcurrent_end(vector *v)
+{
+	(void) v;
+	return NULL;
+}
+
+#endif
+
+
+
+//		PARALLEL OPERATIONS
+
+#ifdef VECTOR_THREADS
+
+/* Pool of worker threads that process the chunks of a job */
+struct vpoolStruct
+{
+	pthread_t *threads;
+	size_t nthreads;
+	pthread_mutex_t run;
+	pthread_mutex_t lock;
+	pthread_cond_t start;
+	pthread_cond_t done;
+
+	//Current job, protected by 'lock'
+	void (*job)(void *arg, size_t chunk);
+	void *arg;
+	size_t nchunks;
+	size_t next;
+	size_t pending;
+	unsigned long generation;
+	int quit;
+};
+
+/*
+Processes chunks of the current job until none are left.
+Must be called with the lock held, and returns with it held.
+*/
+static void vpool_work(vpool *p)
+{
+	while(p->next < p->nchunks){
+		size_t c = p->next++;
+		void (*job)(void *, size_t) = p->job;
+		void *arg = p->arg;
+		pthread_mutex_unlock(&p->lock);
+		job(arg, c);
+		pthread_mutex_lock(&p->lock);
+		if(--p->pending == 0)
+			pthread_cond_broadcast(&p->done);
+	}
+}
+
+/* Main loop of worker threads */
+static void *vpool_worker(void *arg)
+{
+	vpool *p = arg;
+	unsigned long seen = 0;
+	pthread_mutex_lock(&p->lock);
+	for(;;){
+		while(p->generation == seen && !p->quit)
+			pthread_cond_wait(&p->start, &p->lock);
+		if(p->quit)
+			break;
+		seen = p->generation;
+		vpool_work(p);
+	}
+	pthread_mutex_unlock(&p->lock);
+	return NULL;
+}
+
+/*
+Allocates a pool of 'n' threads, counting the calling thread,
+which works along with the pool.
+If 'n' is zero, one thread per processor is used.
+*/
+vpool *vpool_new(size_t n)
+{
+	if(n == 0){
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		n = cpus > 0 ? (size_t)cpus : 1;
+	}
+	vpool *p = malloc(sizeof(vpool));
+	if(!p)
+		return NULL;
+	p->threads = malloc((n-1 ? n-1 : 1)*sizeof(pthread_t));
+	if(!p->threads){
+		free(p);
+		return NULL;
+	}
+	pthread_mutex_init(&p->run, NULL);
+	pthread_mutex_init(&p->lock, NULL);
+	pthread_cond_init(&p->start, NULL);
+	pthread_cond_init(&p->done, NULL);
+	p->job = NULL;
+	p->arg = NULL;
+	p->nchunks = 0;
+	p->next = 0;
+	p->pending = 0;
+	p->generation = 0;
+	p->quit = 0;
+
+	p->nthreads = 1;
+	for(size_t k=0; k<n-1; k++){
+		if(pthread_create(&p->threads[k], NULL, vpool_worker, p) != 0)
+			break;
+		p->nthreads++;
+	}
+	return p;
+}
+
+/* Stops the threads of the pool and frees it */
+void vpool_free(vpool *p)
+{
+	if(!p)
+		return;
+	pthread_mutex_lock(&p->lock);
+	p->quit = 1;
+	pthread_cond_broadcast(&p->start);
+	pthread_mutex_unlock(&p->lock);
+	for(size_t k=0; k<p->nthreads-1; k++)
+		pthread_join(p->threads[k], NULL);
+	pthread_mutex_destroy(&p->run);
+	pthread_mutex_destroy(&p->lock);
+	pthread_cond_destroy(&p->start);
+	pthread_cond_destroy(&p->done);
+	free(p->threads);
+	free(p);
+}
+
+/* Returns the number of threads of the pool, counting the caller */
+size_t vpool_size(vpool *p)
+{
+	return p ? p->nthreads : 1;
+}
+
+/*
+Runs 'job' on chunks 0 to 'nchunks'-1 across the pool,
+and returns once all of them are done.
+The pool runs one job at a time, held by the 'run' lock:
+if it is busy, e.g. when called from another thread or from
+the callback of a job of the same pool, which would otherwise
+overwrite the current job or wait for itself, the chunks
+run on the calling thread instead.
+*/
+static void vpool_run(vpool *p, void (*job)(void *, size_t),
+			void *arg, size_t nchunks)
+{
+	if(!p || nchunks <= 1 || pthread_mutex_trylock(&p->run) != 0){
+		for(size_t c=0; c<nchunks; c++)
+			job(arg, c);
+		return;
+	}
+	pthread_mutex_lock(&p->lock);
+	p->job = job;
+	p->arg = arg;
+	p->nchunks = nchunks;
+	p->next = 0;
+	p->pending = nchunks;
+	p->generation++;
+	pthread_cond_broadcast(&p->start);
+	vpool_work(p);
+	while(p->pending > 0)
+		pthread_cond_wait(&p->done, &p->lock);
+	pthread_mutex_unlock(&p->lock);
+	pthread_mutex_unlock(&p->run);
+}
+
+#else
+
+vpool *vpool_new(size_t n)
+{
+	(void) n;
+	return NULL;
+}
+
+void vpool_free(vpool *p)
+{
+	(void) p;
+}
+
+size_t vpool_size(vpool *p)
+{
+	(void) p;
+	return 1;
+}
+
+static void vpool_run(vpool *p, void (*job)(void *, size_t),
+			void *arg, size_t nchunks)
+{
+	(void) p;
+	for(size_t c=0; c<nchunks; c++)
+		job(arg, c);
+}
+
+#endif
+
+
+/* Splitting of a vector operation into chunks */
+typedef struct vjobStruct
+{
+	vslice s;
+	vector *dest;
+	size_t chunk;
+	size_t head;
+	void *ctx;
+	const void *src;
+	void (*elem_fn)(void *, size_t, void *);
+	void (*map_fn)(void *, const void *, void *);
+	void (*reduce_fn)(void *, const void *, void *);
+	char *partials;
+	size_t acc_size;
+} vjob;
+
+/*
+Splits the job into chunks of the members of 'w', the ones the job
+writes to, or reads for reductions, and returns their number.
+Chunk 'c' ends at member head + (c+1)*chunk, where 'head' is the
+first member that starts a cache line of the data, and 'chunk'
+spans whole cache lines, so that threads do not write to the
+same line. This is only possible if some member starts a line,
+e.g. it is not for 8-byte members at an odd multiple of 4 bytes,
+in which case the chunks start at member zero.
+The work is split in several chunks per thread to balance it.
+*/
+static size_t vjob_split(vjob *j, vslice w, vpool *pool)
+{
+	size_t n = w.size, dt = w.stride, threads = vpool_size(pool);
+	j->head = 0;
+	if(threads == 1 || n < VECTOR_PARALLEL_MIN){
+		j->chunk = n;
+		return n > 0;
+	}
+
+	//Members per chunk: a multiple of the members that fill whole lines
+	size_t line = 1;
+	while(dt && (line*dt) % VECTOR_CACHE_LINE != 0 && line < VECTOR_CACHE_LINE)
+		line++;
+	size_t c = n / (4*threads) + 1;
+	c = (c + line - 1) / line * line;
+	j->chunk = c;
+
+	for(size_t i=0; i<line && i<n; i++){
+		if(((uintptr_t)w.d + i*dt) % VECTOR_CACHE_LINE == 0){
+			j->head = i;
+			break;
+		}
+	}
+	return (n - j->head + c - 1) / c;
+}
+
+/* Returns the range of members of chunk 'c' */
+static size_t vjob_range(vjob *j, size_t c, size_t *n)
+{
+	size_t first = c ? j->head + c*j->chunk : 0;
+	size_t end = j->head + (c+1)*j->chunk;
+	if(end > j->s.size)
+		end = j->s.size;
+	*n = end - first;
+	return first;
+}
+
+static void vjob_for_each(void *arg, size_t c)
+{
+	vjob *j = arg;
+	size_t n, first = vjob_range(j, c, &n);
+	size_t dt = j->s.stride;
+	char *d = (char*)j->s.d + first*dt;
+	for(size_t i=0; i<n; i++)
+		j->elem_fn(d + i*dt, first + i, j->ctx);
+}
+
+static void vjob_map(void *arg, size_t c)
+{
+	vjob *j = arg;
+	size_t n, first = vjob_range(j, c, &n);
+	size_t dt = j->s.stride, ot = j->dest->dtype;
+	const char *in = (char*)j->s.d + first*dt;
+	char *out = (char*)j->dest->d + first*ot;
+	for(size_t i=0; i<n; i++)
+		j->map_fn(out + i*ot, in + i*dt, j->ctx);
+}
+
+static void vjob_reduce(void *arg, size_t c)
+{
+	vjob *j = arg;
+	size_t n, first = vjob_range(j, c, &n);
+	size_t dt = j->s.stride;
+	const char *in = (char*)j->s.d + first*dt;
+	void *acc = j->partials + c*j->acc_size;
+	for(size_t i=0; i<n; i++)
+		j->reduce_fn(acc, in + i*dt, j->ctx);
+}
+
+static void vjob_fill(void *arg, size_t c)
+{
+	vjob *j = arg;
+	size_t n, first = vjob_range(j, c, &n);
+	size_t dt = j->s.dtype;
+	vfill_range((char*)j->s.d + first*dt, n, dt, j->src);
+}
+
+/*
+Calls 'f' on every member of the vector, along with its index
+and the pointer 'ctx'. If 'pool' is not NULL, the vector is
+split in chunks processed by the threads of the pool.
+*/
+vector *vfor_each(vector *v, void (*f)(void *elem, size_t i, void *ctx),
+			void *ctx, vpool *pool)
+{
+	vslfor_each(vslice_of(v, 0, v->size), f, ctx, pool);
+	return v;
+}
+
+/* Same as vfor_each, for the members of a slice */
+void vslfor_each(vslice s, void (*f)(void *elem, size_t i, void *ctx),
+			void *ctx, vpool *pool)
+{
+	vjob j = {0};
+	j.s = s;
+	j.elem_fn = f;
+	j.ctx = ctx;
+	size_t nchunks = vjob_split(&j, s, pool);
+	vpool_run(pool, vjob_for_each, &j, nchunks);
+}
+
+/*
+Resizes 'dest' to the size of 'src', and stores in each of its
+members the result of calling 'f' on the member of 'src'
+at the same index. Both vectors may differ in member size.
+If 'pool' is not NULL, the work is split across its threads.
+*/
+vector *vmap(vector *dest, vector *src,
+			void (*f)(void *out, const void *in, void *ctx),
+			void *ctx, vpool *pool)
+{
+	if(dest != src && !vresize(dest, src->size))
+		return NULL;
+	vjob j = {0};
+	j.s = vslice_of(src, 0, src->size);
+	j.dest = dest;
+	j.map_fn = f;
+	j.ctx = ctx;
+	size_t nchunks = vjob_split(&j, vslice_of(dest, 0, dest->size), pool);
+	vpool_run(pool, vjob_map, &j, nchunks);
+	return dest;
+}
+
+/*
+Reduces the vector into the accumulator 'acc' of 'acc_size' bytes,
+which must hold the identity of the reduction on input,
+e.g. zero for a sum. 'f' adds a member into an accumulator,
+and 'combine' adds a partial accumulator into another.
+If 'pool' is not NULL, each chunk is reduced into its own partial
+accumulator by the threads of the pool, and the partials are
+combined in order on the calling thread.
+*/
+void *vreduce(vector *v, void *acc, size_t acc_size,
+			void (*f)(void *acc, const void *elem, void *ctx),
+			void (*combine)(void *acc, const void *part, void *ctx),
+			void *ctx, vpool *pool)
+{
+	return vslreduce(vslice_of(v, 0, v->size), acc, acc_size,
+			f, combine, ctx, pool);
+}
+
+/* Same as vreduce, for the members of a slice */
+void *vslreduce(vslice s, void *acc, size_t acc_size,
+			void (*f)(void *acc, const void *elem, void *ctx),
+			void (*combine)(void *acc, const void *part, void *ctx),
+			void *ctx, vpool *pool)
+{
+	if(acc_size == 0)
+		return NULL;
+	vjob j = {0};
+	j.s = s;
+	j.reduce_fn = f;
+	j.ctx = ctx;
+	j.acc_size = acc_size;
+	size_t nchunks = vjob_split(&j, s, pool);
+	if(nchunks <= 1){
+		const char *d = s.d;
+		for(size_t i=0; i<s.size; i++)
+			f(acc, d + i*s.stride, ctx);
+		return acc;
+	}
+
+	/*
+	Partial accumulators are padded to whole cache lines,
+	in a block rounded up to a line so they never share one
+	*/
+	j.acc_size = (acc_size + VECTOR_CACHE_LINE - 1) / VECTOR_CACHE_LINE * VECTOR_CACHE_LINE;
+	if(nchunks > (SIZE_MAX - VECTOR_CACHE_LINE) / j.acc_size)
+		return NULL;
+	char *raw = malloc(nchunks*j.acc_size + VECTOR_CACHE_LINE - 1);
+	if(!raw)
+		return NULL;
+	uintptr_t a = ((uintptr_t)raw + VECTOR_CACHE_LINE - 1) & ~(uintptr_t)(VECTOR_CACHE_LINE - 1);
+	j.partials = raw + (a - (uintptr_t)raw);
+	for(size_t c=0; c<nchunks; c++)
+		memcpy(j.partials + c*j.acc_size, acc, acc_size);
+	vpool_run(pool, vjob_reduce, &j, nchunks);
+	for(size_t c=0; c<nchunks; c++)
+		combine(acc, j.partials + c*j.acc_size, ctx);
+	free(raw);
+	return acc;
+}
+
+/*
+Substitutes every member in the vector with the input member,
+splitting the work across the threads of 'pool'.
+*/
+vector *vfill_parallel(vector *v, void *src, vpool *pool)
+{
+	vjob j = {0};
+	j.s = vslice_of(v, 0, v->size);
+	j.src = src;
+	size_t nchunks = vjob_split(&j, j.s, pool);
+	vpool_run(pool, vjob_fill, &j, nchunks);
+	return v;
+}
@@ -6,8 +6,54 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <assert.h>
 
 
+/* Capacity of a vector on its first allocation */
+#define VECTOR_MIN_CAPACITY 4
+
+/* Factor by which the capacity is multiplied when full */
+#define VECTOR_GROWTH 2
+
+/*
+Size of the header at the start of vector files,
+after which the members are stored
+*/
+#define VECTOR_FILE_HEADER 64
+
+/* Default size of the chunks of segmented vectors, in bytes */
+#define SVECTOR_CHUNK_BYTES 65536
+
+/* Size of a cache line, in bytes */
+#define VECTOR_CACHE_LINE 64
+
+/* Largest block copied at once by vfill */
+#define VECTOR_FILL_BLOCK 65536
+
+/* Minimum size for operations to be split across threads */
+#define VECTOR_PARALLEL_MIN 16384
+
+/* Ranges up to this size are sorted by insertion */
+#define VECTOR_SORT_SMALL 16
+
+/* Minimum size for typed sorts to use radix sort */
+#define VECTOR_RADIX_MIN 256
+
+
+/*
+Set of functions used by a vector to manage its memory.
+Each function receives the pointer 'ctx' as first argument.
+Sizes of the blocks being resized or freed are passed on
+for allocators that need them.
+If 'realloc_fn' is NULL, a new block is allocated and copied instead.
+*/
+typedef struct vallocatorStruct
+{
+	void *(*malloc_fn)(void *ctx, size_t bytes);
+	void *(*realloc_fn)(void *ctx, void *ptr, size_t old_bytes, size_t new_bytes);
+	void (*free_fn)(void *ctx, void *ptr, size_t bytes);
+	void *ctx;
+} vallocator;
 
 
 typedef struct vectorStruct
@@ -15,15 +61,119 @@ typedef struct vectorStruct
 	void *d;
 	size_t size;
 	size_t dtype;
+	size_t capacity;
+	unsigned int flags;
+	const vallocator *alloc;
+	struct vmapStruct *map;
+	struct vconcStruct *conc;
+	void *raw;
+	size_t align;
+	size_t pad;
 } vector;
 
 
+/*
+Declares a structure that holds a vector along with
+an inline buffer for its first 'N' members of type 'T'.
+Initialise it with VSMALL_INIT, which returns the vector.
+e.g.
+	VSMALL(int, 8) s;
+	vector *v = VSMALL_INIT(s);
+	...
+	vfree(v);
+The structure must not be copied while the members
+are kept in the buffer.
+*/
+#define VSMALL(T, N) struct { vector v; T buf[N]; }
+
+#define VSMALL_INIT(s) vinit_buffer(&(s).v, sizeof((s).buf[0]),\
+			(s).buf, sizeof((s).buf)/sizeof((s).buf[0]))
+
+
 
 /*
 Allocates new vector and returns pointer to it
 */
 vector *vnew(size_t bytes);
 
+/*
+Allocates new vector that obtains all its memory,
+including the vector object, from the allocator 'a'.
+The allocator must outlive the vector.
+If 'a' is NULL, the standard library is used.
+*/
+vector *vnew_with_allocator(size_t bytes, const vallocator *a);
+
+/*
+Allocates new vector whose data starts at a multiple of
+'align' bytes, which must be a power of two, and is followed
+by 'pad' bytes past its capacity, so that the last members
+can be read with full SIMD-width loads.
+Both are kept when the vector grows.
+If 'align' is zero, VECTOR_CACHE_LINE is used.
+*/
+vector *vnew_aligned(size_t bytes, size_t align, size_t pad);
+
+/*
+Initialises a vector object provided by the caller,
+e.g. on the stack or inside another structure.
+It must still be freed with vfree.
+*/
+vector *vinit(vector *v, size_t bytes);
+
+/*
+Initialises a vector object provided by the caller
+that stores its first 'n' members in the buffer 'buf'.
+Memory is only allocated once the vector grows past 'n' members.
+*/
+vector *vinit_buffer(vector *v, size_t bytes, void *buf, size_t n);
+
+/*
+Creates a new vector of members of 'bytes' bytes
+whose data is stored in the file at 'path',
+which is created or overwritten.
+The vector is used as any other, and grows the file as needed.
+Only available on systems with mmap.
+*/
+vector *vnew_mapped(const char *path, size_t bytes);
+
+/*
+Opens a vector stored in the file at 'path'
+by vnew_mapped or vsave, without reading it into memory.
+Changes to the vector are written back to the file.
+*/
+vector *vopen_mapped(const char *path);
+
+/*
+Writes the changes to a file-backed vector to its file,
+including its size. Other vectors are left untouched.
+*/
+vector *vsync(vector *v);
+
+/*
+Saves the vector into the file at 'path', as a header
+followed by the raw members, which can be read back with
+vload, vload_view or vopen_mapped.
+*/
+vector *vsave(vector *v, const char *path);
+
+/*
+Loads a vector saved with vsave into a new vector.
+Returns NULL if the file cannot be read, was written on
+a machine of different byte order, or fails its checksum.
+*/
+vector *vload(const char *path);
+
+/*
+Opens a vector stored in the file at 'path' by vsave
+or vnew_mapped, mapping it into memory instead of reading it.
+The checksum is not verified, and the file is never modified:
+changed members are copied in memory as needed,
+and the whole vector is read into memory once it grows.
+On systems without mmap, it behaves as vload.
+*/
+vector *vload_view(const char *path);
+
 
 //		GETTERS
 /*
@@ -51,10 +201,20 @@ of a vector 'v' and casts it to a double.
 void *vat(vector *v, size_t i);
 
 /*
-Returns the total memory allocated for the vector
+Returns the heap memory allocated for the vector: its structure,
+unless it is embedded, and the block of its members, which for
+aligned vectors includes the alignment slack and padding.
+The inline buffer of VSMALL vectors and the file mapping
+of mapped vectors are not counted.
 */
 size_t vmem(vector *v);
 
+/*
+Returns the number of members the vector
+can hold without reallocating
+*/
+size_t vcapacity(vector *v);
+
 
 
 //		SETTERS
@@ -82,13 +242,741 @@ vector *vinsert(vector *v, size_t j, void *new);
 /* Removes member 'i' from vector */
 vector *vdelete(vector *v, size_t i);
 
+/*
+Inserts 'n' members from the array 'src'
+into the vector at index 'j'.
+The array may point into the vector itself.
+*/
+vector *vinsert_range(vector *v, size_t j, const void *src, size_t n);
+
+/*
+Appends 'n' members from the array 'src'
+at the end of the vector.
+*/
+vector *vappend_array(vector *v, const void *src, size_t n);
+
+/*
+Removes 'n' members from vector
+starting at index 'i'.
+*/
+vector *vdelete_range(vector *v, size_t i, size_t n);
+
+/*
+Removes member 'i' from vector by moving
+the last member into its place.
+The order of the members is not preserved.
+*/
+vector *vswap_remove(vector *v, size_t i);
+
+/*
+Removes every member for which 'pred' returns non-zero,
+keeping the order of the remaining members.
+The argument 'ctx' is passed on to 'pred'.
+e.g.
+	int is_neg(void *x, void *ctx){ return *(int*)x < 0; }
+	vremove_if(v, is_neg, NULL);
+*/
+vector *vremove_if(vector *v, int (*pred)(void *, void *), void *ctx);
+
+/* Appends a new member at the end of the vector */
+vector *vpush(vector *v, void *new);
+
+/*
+Removes the last member of the vector.
+If 'dest' is not NULL, the member is copied into it.
+*/
+vector *vpop(vector *v, void *dest);
+
+/*
+Returns a pointer to the last member of the vector,
+or NULL if it is empty.
+*/
+void *vback(vector *v);
+
+/*
+Appends a new uninitialised member at the end of the vector,
+and returns a pointer to it so that it can be written in place.
+e.g.
+	struct event *e = vemplace(v);
+	e->time = t;
+*/
+void *vemplace(vector *v);
+
+/*
+Changes the size of a vector directly.
+Reducing the size does not free memory.
+*/
 vector *vresize(vector *v, size_t newsize);
 
+/*
+Allocates memory for at least 'n' members,
+without changing the size of the vector.
+*/
+vector *vreserve(vector *v, size_t n);
+
+/*
+Frees the unused allocated memory,
+so that capacity equals size.
+*/
+vector *vshrink_to_fit(vector *v);
+
+/*
+Frees the vector.
+Vectors initialised with vinit only have their data freed.
+File-backed vectors save their size and close their file.
+*/
 void vfree(vector *v);
 
 /* Converts an array into a vector */
 vector *vtovector(void *arr, size_t elem_num, size_t elem_size);
 
+/*
+Converts an array allocated with malloc into a vector
+without copying it. The vector takes ownership of the array,
+which is freed along with it.
+Returns NULL on fail, in which case the array is not freed.
+*/
+vector *vadopt(void *arr, size_t elem_num, size_t elem_size);
+
+/*
+Frees the vector, except for its data, which is returned
+without copying it. The caller takes ownership of the data,
+to be freed with free, or with the allocator of the vector.
+Only vectors on the heap can be released: NULL is returned
+for file-backed, aligned and inline buffer vectors.
+*/
+void *vrelease(vector *v);
+
+
+
+//		CONCURRENT APPEND
+
+/*
+Switches the vector to concurrent append mode, reserving
+memory for at least 'n' members. Until vconcurrent_end is called,
+only vpush_concurrent, vsize_concurrent and vat_concurrent
+may be used on the vector, from any number of threads.
+File-backed vectors, aligned vectors and vectors using
+an inline buffer cannot be switched. Requires C11 atomics.
+*/
+vector *vconcurrent_begin(vector *v, size_t n);
+
+/*
+Appends a new member to a vector in concurrent append mode.
+Threads claim slots with an atomic counter and mark each member
+as ready on its own, so they only wait on each other while
+the vector grows.
+*/
+vector *vpush_concurrent(vector *v, const void *new);
+
+/*
+Returns the number of slots claimed so far in a vector
+in concurrent append mode. Members are written in any order,
+so some of them may not be ready yet.
+*/
+size_t vsize_concurrent(vector *v);
+
+/*
+Returns a pointer to a member of a vector in concurrent
+append mode, or NULL if it has not been written yet.
+It stays valid until vconcurrent_end is called.
+*/
+void *vat_concurrent(vector *v, size_t i);
+
+/*
+Switches the vector back to normal mode, once every thread
+has finished with it.
+*/
+vector *vconcurrent_end(vector *v);
+
+
+
+//		SORTING
+
+/*
+Sorts the vector in place in the order given
+by the comparison function 'cmp', which behaves
+as the one taken by qsort.
+*/
+vector *vsort(vector *v, int (*cmp)(const void *, const void *));
+
+/*
+Sort vectors of 32-bit signed integers, 64-bit unsigned
+integers or doubles in ascending order, using radix sort
+for vectors of at least VECTOR_RADIX_MIN members.
+They return NULL if the member size does not match.
+*/
+vector *vsort_i32(vector *v);
+vector *vsort_u64(vector *v);
+vector *vsort_f64(vector *v);
+
+
+
+//		SORTED VECTORS
+
+/*
+Returns the index of the first member that does not
+compare less than 'key', or the size of the vector if
+there is none. The vector must be sorted by 'cmp'.
+*/
+size_t vlower_bound(vector *v, const void *key,
+			int (*cmp)(const void *, const void *));
+
+/*
+Returns the index of the first member that compares
+greater than 'key', or the size of the vector if
+there is none. The vector must be sorted by 'cmp'.
+*/
+size_t vupper_bound(vector *v, const void *key,
+			int (*cmp)(const void *, const void *));
+
+/*
+Inserts a new member into a vector sorted by 'cmp',
+after any members that compare equal to it.
+*/
+vector *vsorted_insert(vector *v, void *new,
+			int (*cmp)(const void *, const void *));
+
+/*
+Merges the 'n' members of the array 'src' into the vector,
+both sorted by 'cmp', so that the vector remains sorted.
+Members of the vector are placed before equal members of 'src'.
+The array must not point into the vector.
+*/
+vector *vmerge_sorted(vector *v, const void *src, size_t n,
+			int (*cmp)(const void *, const void *));
+
+/*
+Returns a new vector with the members of the sorted vector 'v'
+in Eytzinger layout, where the children of member 'k' are at
+2k+1 and 2k+2. Searching it with veytzinger_search touches
+fewer cache lines than a binary search on large vectors.
+*/
+vector *veytzinger(vector *v);
+
+/*
+Returns the index in the Eytzinger vector 'e' of the first
+member, in sorted order, that does not compare less than 'key',
+or the size of the vector if there is none.
+*/
+size_t veytzinger_search(vector *e, const void *key,
+			int (*cmp)(const void *, const void *));
+
+
+
+//		SLICES
+
+/*
+Non-owning view of 'size' members of 'dtype' bytes,
+the first at 'd' and each 'stride' bytes after the previous one.
+Slices are passed by value, and do not need to be freed.
+They are invalidated by any function that changes
+the capacity of the vector they point into.
+Only the functions named vsl* take slices, including
+vslfor_each and vslreduce under PARALLEL OPERATIONS:
+the other functions of this file take whole vectors.
+*/
+typedef struct vsliceStruct
+{
+	void *d;
+	size_t size;
+	size_t dtype;
+	size_t stride;
+} vslice;
+
+/*
+Returns a slice of the 'n' members of the vector
+from index 'first'. It is cut at the end of the vector.
+*/
+vslice vslice_of(vector *v, size_t first, size_t n);
+
+/*
+Returns a slice of up to 'n' members of the vector
+from index 'first', taking one of every 'step' members.
+*/
+vslice vslice_step(vector *v, size_t first, size_t n, size_t step);
+
+/* Returns a contiguous slice of the array 'arr' */
+vslice vslice_array(void *arr, size_t n, size_t dtype);
+
+/* Returns the number of members of the slice */
+size_t vslsize(vslice s);
+
+/* Returns non-zero if the members of the slice are contiguous */
+int vslcontiguous(vslice s);
+
+/* Returns a pointer to member 'i' of the slice */
+void *vslat(vslice s, size_t i);
+
+/* Allocates new vector with a copy of the members of the slice */
+vector *vslcopy(vslice s);
+
+/*
+Expands to the pointer and size of a slice of members of type 'T',
+to pass it to functions that take an array and its length,
+e.g. those in utils.h. Only valid for contiguous slices,
+which is asserted in debug builds: strided slices would
+be read as if their members were contiguous.
+Copy strided slices into a vector first:
+	double sum = fltsum(VSLARGS(double, s));
+
+	vector *c = vslcopy(strided);
+	double sum = fltsum(vdata(c), vsize(c));
+	vfree(c);
+*/
+#define VSLARGS(T, s) (assert(vslcontiguous(s)), (T *) (s).d), (s).size
+
+/* Same as vlower_bound and vupper_bound, for sorted slices */
+size_t vsllower_bound(vslice s, const void *key,
+			int (*cmp)(const void *, const void *));
+size_t vslupper_bound(vslice s, const void *key,
+			int (*cmp)(const void *, const void *));
+
+
+
+//		PARALLEL OPERATIONS
+
+/* Pool of worker threads */
+typedef struct vpoolStruct vpool;
+
+/*
+Allocates a pool of 'n' threads, counting the calling thread,
+which works along with the pool.
+If 'n' is zero, one thread per processor is used.
+Requires POSIX threads: returns NULL otherwise.
+*/
+vpool *vpool_new(size_t n);
+
+/* Stops the threads of the pool and frees it */
+void vpool_free(vpool *p);
+
+/* Returns the number of threads of the pool, counting the caller */
+size_t vpool_size(vpool *p);
+
+/*
+The following functions split the vector in chunks processed
+by the threads of 'pool'. Chunk boundaries fall on cache line
+boundaries of the vector being written, so that threads do not
+write to the same line, unless no member starts a line,
+e.g. 8-byte members at an odd multiple of 4 bytes.
+If 'pool' is NULL, or the vector has fewer than
+VECTOR_PARALLEL_MIN members, they run on the calling thread.
+A pool runs one operation at a time: an operation started while
+it is busy, from another thread or from the input function of
+an operation on the same pool, runs on the calling thread.
+The pointer 'ctx' is passed on to the input functions,
+which must be safe to call from several threads at once.
+*/
+
+/*
+Calls 'f' on every member of the vector, along with its index
+*/
+vector *vfor_each(vector *v, void (*f)(void *elem, size_t i, void *ctx),
+			void *ctx, vpool *pool);
+
+/*
+Resizes 'dest' to the size of 'src', and stores in each of its
+members the result of calling 'f' on the member of 'src'
+at the same index. Both vectors may differ in member size,
+and may be the same vector.
+*/
+vector *vmap(vector *dest, vector *src,
+			void (*f)(void *out, const void *in, void *ctx),
+			void *ctx, vpool *pool);
+
+/*
+Reduces the vector into the accumulator 'acc' of 'acc_size' bytes,
+which must hold the identity of the reduction on input,
+e.g. zero for a sum. 'f' adds a member into an accumulator,
+and 'combine' adds a partial accumulator into another.
+Returns 'acc', or NULL on fail or if 'acc_size' is zero.
+*/
+void *vreduce(vector *v, void *acc, size_t acc_size,
+			void (*f)(void *acc, const void *elem, void *ctx),
+			void (*combine)(void *acc, const void *part, void *ctx),
+			void *ctx, vpool *pool);
+
+/*
+Same as vfor_each and vreduce, for the members of a slice,
+which may be strided. The index passed to 'f' is the one
+of the member in the slice.
+*/
+void vslfor_each(vslice s, void (*f)(void *elem, size_t i, void *ctx),
+			void *ctx, vpool *pool);
+void *vslreduce(vslice s, void *acc, size_t acc_size,
+			void (*f)(void *acc, const void *elem, void *ctx),
+			void (*combine)(void *acc, const void *part, void *ctx),
+			void *ctx, vpool *pool);
+
+/* Substitutes every member in the vector with the input member */
+vector *vfill_parallel(vector *v, void *src, vpool *pool);
+
+
+
+//		DOUBLE-ENDED QUEUE
+
+/*
+Queue that stores its members in a ring buffer,
+so that members can be added and removed at both ends
+in constant time. Its capacity is always a power of two.
+*/
+typedef struct vdequeStruct
+{
+	void *d;
+	size_t head;
+	size_t size;
+	size_t dtype;
+	size_t capacity;
+} vdeque;
+
+/*
+Allocates new double-ended queue of members
+of 'bytes' bytes and returns pointer to it
+*/
+vdeque *vdqnew(size_t bytes);
+
+/* Frees the queue */
+void vdqfree(vdeque *q);
+
+/* Returns the number of members in the queue */
+size_t vdqsize(vdeque *q);
+
+/* Allocates memory for at least 'n' members */
+vdeque *vdqreserve(vdeque *q, size_t n);
+
+/*
+Returns a pointer to the member at index 'i',
+counting from the front of the queue
+*/
+void *vdqat(vdeque *q, size_t i);
+
+/* Return a pointer to the first or last member, or NULL if empty */
+void *vdqfront(vdeque *q);
+void *vdqback(vdeque *q);
+
+/* Add a new member at the back or front of the queue */
+vdeque *vdqpush_back(vdeque *q, const void *new);
+vdeque *vdqpush_front(vdeque *q, const void *new);
+
+/*
+Remove the last or first member of the queue.
+If 'dest' is not NULL, the member is copied into it.
+*/
+vdeque *vdqpop_back(vdeque *q, void *dest);
+vdeque *vdqpop_front(vdeque *q, void *dest);
+
+/*
+Removes the first 'n' members of the queue,
+e.g. after processing them through vdqspan.
+*/
+vdeque *vdqdrop_front(vdeque *q, size_t n);
+
+/*
+Returns a pointer to the first member, and stores in 'n'
+the number of members that follow it contiguously in memory,
+before the queue wraps around.
+e.g.
+	size_t n;
+	T *p;
+	while( (p = vdqspan(q, &n)) ){
+		process(p, n);
+		vdqdrop_front(q, n);
+	}
+*/
+void *vdqspan(vdeque *q, size_t *n);
+
+/*
+Rearranges the queue so that all of its members are
+contiguous in memory, and returns a pointer to the first one.
+*/
+void *vdqlinearize(vdeque *q);
+
+
+
+//		SEGMENTED VECTOR
+
+/*
+Vector that stores its members in chunks of a fixed
+power of two size, found through a table of chunks.
+Members never move once added, so pointers to them stay valid,
+and growing never copies the existing members.
+*/
+typedef struct svectorStruct
+{
+	void **chunks;
+	size_t nchunks;
+	size_t tablecap;
+	size_t size;
+	size_t dtype;
+	size_t shift;
+} svector;
+
+/*
+Allocates new segmented vector of members of 'bytes' bytes,
+stored in chunks of 'chunk' members, and returns pointer to it.
+The chunk size is rounded up to a power of two.
+If 'chunk' is zero, chunks of about SVECTOR_CHUNK_BYTES are used.
+*/
+svector *svnew(size_t bytes, size_t chunk);
+
+/* Frees the segmented vector */
+void svfree(svector *s);
+
+/* Returns the size of the segmented vector */
+size_t svsize(svector *s);
+
+/* Returns the number of members per chunk */
+size_t svchunk_size(svector *s);
+
+/* Allocates chunks to hold at least 'n' members */
+svector *svreserve(svector *s, size_t n);
+
+/*
+Returns a pointer to a member of the segmented vector.
+Pointers stay valid until the member is removed.
+*/
+void *svat(svector *s, size_t i);
+
+/* Changes the value of a member */
+svector *svset(svector *s, size_t i, const void *src);
+
+/* Appends a new member at the end of the segmented vector */
+svector *svpush(svector *s, const void *new);
+
+/*
+Appends a new uninitialised member at the end of the
+segmented vector and returns a pointer to it.
+*/
+void *svemplace(svector *s);
+
+/*
+Removes the last member of the segmented vector.
+If 'dest' is not NULL, the member is copied into it.
+*/
+svector *svpop(svector *s, void *dest);
+
+/* Returns the number of chunks that hold members */
+size_t svnchunks(svector *s);
+
+/*
+Returns a pointer to the first member of chunk 'k',
+and stores in 'n' the number of members it holds,
+so that the vector can be processed chunk by chunk.
+Returns NULL if the chunk holds no members.
+e.g.
+	for(size_t k=0; k<svnchunks(s); k++){
+		size_t n;
+		T *p = svchunk(s, k, &n);
+		process(p, n);
+	}
+*/
+void *svchunk(svector *s, size_t k, size_t *n);
+
+
+//		STRUCT OF ARRAYS
+
+/*
+Table of records stored as one contiguous column per field,
+all sharing the same size and capacity, so that loops over
+a few fields only read those columns.
+Columns are plain arrays, which can be passed to the
+array functions of utils.h along with soasize.
+*/
+typedef struct vsoaStruct
+{
+	void **cols;
+	size_t *dtypes;
+	size_t ncols;
+	size_t size;
+	size_t capacity;
+} vsoa;
+
+/*
+Allocates new struct of arrays with 'ncols' columns,
+whose members are of 'dtypes[c]' bytes, and returns pointer to it.
+e.g.
+	size_t fields[] = {sizeof(double), sizeof(double), sizeof(int)};
+	vsoa *s = soanew(3, fields);
+*/
+vsoa *soanew(size_t ncols, const size_t *dtypes);
+
+/* Frees the struct of arrays */
+void soafree(vsoa *s);
+
+/* Returns the number of records */
+size_t soasize(vsoa *s);
+
+/* Returns the number of columns */
+size_t soancols(vsoa *s);
+
+/* Returns the number of records that fit without reallocating */
+size_t soacapacity(vsoa *s);
+
+/* Grows every column to hold at least 'n' records */
+vsoa *soareserve(vsoa *s, size_t n);
+
+/*
+Returns a pointer to the first member of column 'c'.
+It is invalidated by any function that changes the capacity.
+e.g.
+	double *x = soacol(s, 0);
+	fltsum(x, soasize(s));
+*/
+void *soacol(vsoa *s, size_t c);
+
+/* Returns a pointer to the member of column 'c' of record 'i' */
+void *soaat(vsoa *s, size_t c, size_t i);
+
+/*
+Copies the fields of record 'i' from the pointers 'fields',
+one per column. Columns whose pointer is NULL are left unchanged.
+*/
+vsoa *soaset(vsoa *s, size_t i, const void *const *fields);
+
+/*
+Copies the fields of record 'i' into the pointers 'dest',
+one per column. Columns whose pointer is NULL are skipped.
+*/
+vsoa *soaget(vsoa *s, size_t i, void *const *dest);
+
+/*
+Inserts a record at index 'j', with its fields copied from the
+pointers 'fields', one per column.
+Fields whose pointer is NULL, or all fields if 'fields'
+is NULL, are set to zero.
+*/
+vsoa *soainsert(vsoa *s, size_t j, const void *const *fields);
+
+/* Appends a record at the end, see soainsert */
+vsoa *soapush(vsoa *s, const void *const *fields);
+
+/* Deletes the record at index 'j', shifting the following ones */
+vsoa *soadelete(vsoa *s, size_t j);
+
+/*
+Deletes the record at index 'j' by moving the last record
+into its place. It does not keep the order of the records.
+*/
+vsoa *soaswap_remove(vsoa *s, size_t j);
+
+/*
+Changes the number of records to 'n'.
+New records are set to zero.
+*/
+vsoa *soaresize(vsoa *s, size_t n);
+
+
+//		TYPED VECTORS
+
+/*
+Generates a family of functions that work on vectors
+of members of type 'T', named with the prefix 'name'.
+They take the same vector objects as the rest of the library,
+but copy members by value and are inlined by the compiler.
+e.g.
+	VECTOR_DEFINE(vdbl, double)
+
+	vector *v = vdbl_new();
+	vdbl_push(v, 3.5);
+	double x = *vdbl_at(v, 0);
+
+The following functions are generated:
+	vector *name_new(void)						see vnew
+	T *name_data(vector *v)						see vdata
+	T *name_at(vector *v, size_t i)				see vat
+	T name_get(vector *v, size_t i)				unchecked value at index 'i'
+	vector *name_set(vector *v, size_t i, T x)	see vset
+	vector *name_push(vector *v, T x)			see vpush
+	vector *name_pop(vector *v, T *dest)		see vpop
+	vector *name_insert(vector *v, size_t j, T x)	see vinsert
+	T *name_begin(vector *v)					see vbegin
+	T *name_end(vector *v)						see vend
+*/
+#define VECTOR_DEFINE(name, T)\
+	static inline vector *name##_new(void){\
+		return vnew(sizeof(T));\
+	}\
+	static inline T *name##_data(vector *v){\
+		return (T *) v->d;\
+	}\
+	static inline T *name##_at(vector *v, size_t i){\
+		if(i >= v->size)\
+			return NULL;\
+		return (T *) v->d + i;\
+	}\
+	static inline T name##_get(vector *v, size_t i){\
+		return ((T *) v->d)[i];\
+	}\
+	static inline vector *name##_set(vector *v, size_t i, T x){\
+		if(i >= v->size)\
+			return NULL;\
+		((T *) v->d)[i] = x;\
+		return v;\
+	}\
+	static inline vector *name##_push(vector *v, T x){\
+		T *p;\
+		if(v->size < v->capacity)\
+			p = (T *) v->d + v->size++;\
+		else if(!(p = (T *) vemplace(v)))\
+			return NULL;\
+		*p = x;\
+		return v;\
+	}\
+	static inline vector *name##_pop(vector *v, T *dest){\
+		if(v->size == 0)\
+			return NULL;\
+		v->size--;\
+		if(dest)\
+			*dest = ((T *) v->d)[v->size];\
+		return v;\
+	}\
+	static inline vector *name##_insert(vector *v, size_t j, T x){\
+		return vinsert_range(v, j, &x, 1);\
+	}\
+	static inline T *name##_begin(vector *v){\
+		return (T *) v->d;\
+	}\
+	static inline T *name##_end(vector *v){\
+		return (T *) v->d + v->size;\
+	}
+
+
+
+//		ITERATION
+
+/*
+Returns a pointer to the first member of the vector,
+and one past its last member. Pointers are invalidated
+by any function that changes the capacity of the vector.
+e.g.
+	for(char *p = vbegin(v); p < (char*) vend(v); p += vdtype(v))
+*/
+static inline void *vbegin(const vector *v)
+{
+	return v->d;
+}
+
+static inline void *vend(const vector *v)
+{
+	return (char *) v->d + v->size*v->dtype;
+}
+
+/*
+Loops over the members of the vector 'v', of type 'T',
+with 'p' a pointer to the current member.
+The end of the vector is read once, so the loop must not
+insert or delete members, and the compiler may vectorise it.
+'T' may itself be a pointer type, since the end is held by
+an enclosing one-shot loop rather than declared beside 'p'.
+e.g.
+	double sum = 0;
+	VFOREACH(double, x, v)
+		sum += *x;
+*/
+#define VFOREACH(T, p, v)\
+	for(void *p##_end = vend(v); p##_end; p##_end = NULL)\
+	for(T *p = (T *) (v)->d; p != (T *) p##_end; p++)
+
 
 
 #endif
\ No newline at end of file